@@ -0,0 +1,221 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ba_graph
+{
+// queue between two stages of a pipeline, push waits while it is full so the producer cannot run far ahead
+template <typename T>
+class BoundedQueue
+{
+  public:
+    explicit BoundedQueue(int capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // false if the queue was closed, the item is dropped then
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this]() { return closed || (int)items.size() < capacity; });
+        if(closed)
+        {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // false once the queue is closed and empty
+    bool pop(T& item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+        if(items.empty())
+        {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // no more pushes, pop returns the remaining items and then false. A push waiting for a free place returns false
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+  private:
+    int capacity;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    bool closed = false;
+};
+
+// runs submitted jobs on a pool of workers and passes the finished ones to output in the order of submission.
+// At most window jobs are in flight, submit outputs the finished ones while it waits for a free place.
+// output and destruction of the jobs happen on the submitting thread. An exception of work is rethrown there by
+// submit or finish once the jobs before the one which threw are output, the jobs after it are dropped
+template <typename Job>
+class OrderedBatch
+{
+  public:
+    OrderedBatch(int threads, std::function<void(int, Job&)> work, std::function<void(Job&)> output, int window = 0)
+        : work(std::move(work)), output(std::move(output)), window(window > 0 ? window : 4 * threads)
+    {
+        for(int i = 0; i < threads; ++i)
+        {
+            workers.emplace_back([this, i]() { run(i); });
+        }
+    }
+
+    ~OrderedBatch()
+    {
+        try
+        {
+            finish();
+        }
+        catch(...)
+        {
+        }
+    }
+
+    void submit(Job job)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while((int)in_flight.size() >= window || failed)
+        {
+            flush(lock);
+        }
+        in_flight.push_back(std::make_unique<Slot>(std::move(job)));
+        queue.push_back(in_flight.back().get());
+        work_ready.notify_one();
+    }
+
+    // wait for all the jobs and output them
+    void finish()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(!in_flight.empty())
+        {
+            flush(lock);
+        }
+        stop(lock);
+    }
+
+  private:
+    struct Slot
+    {
+        Job job;
+        bool done = false;
+        std::exception_ptr error;  // thrown by work
+
+        explicit Slot(Job job) : job(std::move(job)) {}
+    };
+
+    std::function<void(int, Job&)> work;
+    std::function<void(Job&)> output;
+    int window;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable job_done;
+    std::deque<std::unique_ptr<Slot>> in_flight;  // in the order of submission
+    std::deque<Slot*> queue;                      // not yet taken by a worker
+    bool stopping = false;
+    bool failed = false;  // a work threw, no more jobs are taken
+
+    // wait until the oldest job is finished and output the finished ones at the front
+    void flush(std::unique_lock<std::mutex>& lock)
+    {
+        job_done.wait(lock, [this]() { return in_flight.front()->done; });
+        while(!in_flight.empty() && in_flight.front()->done)
+        {
+            std::unique_ptr<Slot> slot = std::move(in_flight.front());
+            in_flight.pop_front();
+            if(slot->error)
+            {
+                // the jobs after it were not started or are finished by the workers before they stop
+                stop(lock);
+                in_flight.clear();
+                std::rethrow_exception(slot->error);
+            }
+            lock.unlock();
+            output(slot->job);
+            slot.reset();
+            lock.lock();
+        }
+    }
+
+    // the workers finish their jobs and end, the lock is released
+    void stop(std::unique_lock<std::mutex>& lock)
+    {
+        stopping = true;
+        queue.clear();
+        work_ready.notify_all();
+        lock.unlock();
+        for(auto& t : workers)
+        {
+            if(t.joinable())
+            {
+                t.join();
+            }
+        }
+    }
+
+    void run(int id)
+    {
+        while(true)
+        {
+            Slot* slot;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock, [this]() { return stopping || !queue.empty(); });
+                if(queue.empty())
+                {
+                    return;
+                }
+                slot = queue.front();
+                queue.pop_front();
+            }
+
+            std::exception_ptr error;
+            try
+            {
+                work(id, slot->job);
+            }
+            catch(...)
+            {
+                error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            slot->done = true;
+            if(error)
+            {
+                // the jobs still queued come after it and are not needed
+                slot->error = error;
+                failed = true;
+                queue.clear();
+            }
+            job_done.notify_one();
+        }
+    }
+};
+}  // namespace ba_graph
+#endif  // BATCH_HPP
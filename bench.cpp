@@ -0,0 +1,465 @@
+#include <impl/basic/include.hpp>
+
+#include "sat/solver_cmsat.hpp"
+#include "ecd.hpp"
+#include "ecd_parallel.hpp"
+#include "ecd_portfolio.hpp"
+#include "ecd_sat.hpp"
+#include "ecd_stats.hpp"
+#include "graph6_stream.hpp"
+#include "util/cxxopts.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Benchmark of the ecd engines inside one process: every configuration is run on every graph of the given files,
+// each graph first warmup times and then repeat times. The median over the repetitions is the time of a graph,
+// the per graph times are summed up and their median and 95th percentile reported. Sizes found by different
+// configurations are compared, and so are the times against a baseline written by an earlier run with --json.
+
+using namespace ba_graph;
+
+cxxopts::Options options("bench", "\nBenchmark the ecd engines on graph6 files.\n");
+
+// engine[:encoding[:symmetry[:two]]], e.g. sat:sequential:breakid:two, or backtracking[:order[:seed]], the missing
+// parts are the defaults
+struct BenchConfig
+{
+    std::string name;
+    std::string engine;
+    EcdEncoding encoding;
+    EcdOrdering ordering;
+};
+
+// one configuration on one file
+struct BenchRun
+{
+    std::string file;
+    std::string config;
+    bool line_graph = false;
+    std::vector<int> sizes;
+    std::vector<double> times;  // median of the repetitions of each graph, seconds
+    long long nodes = 0;
+    long long conflicts = 0;
+    double total = 0;
+    double median = 0;
+    double p95 = 0;
+};
+
+std::vector<std::string> split(const std::string& s, char sep)
+{
+    std::vector<std::string> parts;
+    std::istringstream in(s);
+    for(std::string part; std::getline(in, part, sep);)
+    {
+        if(!part.empty())
+        {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+BenchConfig parse_config(const std::string& name)
+{
+    static const std::map<std::string, AmoEncoding> encodings = {{"pairwise", AmoEncoding::pairwise},
+                                                                 {"sequential", AmoEncoding::sequential},
+                                                                 {"commander", AmoEncoding::commander},
+                                                                 {"ladder", AmoEncoding::ladder}};
+    static const std::map<std::string, SymmetryBreaking> symmetries = {
+      {"graph", SymmetryBreaking::graph}, {"breakid", SymmetryBreaking::breakid}, {"none", SymmetryBreaking::none}};
+    static const std::map<std::string, EcdOrder> orders = {{"numeric", EcdOrder::numeric},
+                                                           {"bfs", EcdOrder::bfs},
+                                                           {"constrained", EcdOrder::constrained},
+                                                           {"degree", EcdOrder::degree},
+                                                           {"random", EcdOrder::random}};
+
+    BenchConfig config{name, "", {}, {}};
+    std::vector<std::string> parts = split(name, ':');
+    if(parts.empty() || parts.size() > 4)
+    {
+        throw std::runtime_error("wrong configuration " + name);
+    }
+    config.engine = parts[0];
+    if(config.engine != "backtracking" && config.engine != "sat" && config.engine != "sat-incremental" &&
+       config.engine != "portfolio")
+    {
+        throw std::runtime_error("wrong engine " + config.engine);
+    }
+    if(config.engine == "backtracking")
+    {
+        if(parts.size() > 3)
+        {
+            throw std::runtime_error("wrong configuration " + name);
+        }
+        if(parts.size() > 1)
+        {
+            if(!orders.count(parts[1]))
+            {
+                throw std::runtime_error("wrong order " + parts[1]);
+            }
+            config.ordering.order = orders.at(parts[1]);
+        }
+        if(parts.size() > 2)
+        {
+            config.ordering.seed = (uint32_t)std::stoul(parts[2]);
+        }
+        return config;
+    }
+    if(parts.size() > 1)
+    {
+        if(!encodings.count(parts[1]))
+        {
+            throw std::runtime_error("wrong encoding " + parts[1]);
+        }
+        config.encoding.at_most_one = encodings.at(parts[1]);
+    }
+    if(parts.size() > 2)
+    {
+        if(!symmetries.count(parts[2]))
+        {
+            throw std::runtime_error("wrong symmetry breaking " + parts[2]);
+        }
+        config.encoding.symmetry = symmetries.at(parts[2]);
+    }
+    if(parts.size() > 3)
+    {
+        if(parts[3] != "two")
+        {
+            throw std::runtime_error("wrong configuration " + name);
+        }
+        config.encoding.exactly_two = true;
+    }
+    return config;
+}
+
+int run_config(const BenchConfig& config, const EdgeList& g, CMSatSolver& solver)
+{
+    if(config.engine == "backtracking")
+    {
+        return ecd_size(g, config.ordering);
+    }
+    if(config.engine == "sat")
+    {
+        return ecd_size_sat(solver, g, config.encoding);
+    }
+    if(config.engine == "sat-incremental")
+    {
+        return ecd_size_sat_incremental(g, config.encoding.symmetry != SymmetryBreaking::none, config.encoding);
+    }
+    return ecd_size_portfolio(g);
+}
+
+template <typename Stream>
+std::vector<EdgeList> read_stream(Stream& stream, bool line_graph, int limit)
+{
+    std::vector<EdgeList> graphs;
+    EdgeList g, lg;
+    while((limit == 0 || (int)graphs.size() < limit) && stream.next(g))
+    {
+        if(line_graph)
+        {
+            ba_graph::line_graph(g, lg);
+            graphs.push_back(lg);
+        }
+        else
+        {
+            graphs.push_back(g);
+        }
+    }
+    return graphs;
+}
+
+// - reads the graphs from stdin, e.g. piped from a generator
+std::vector<EdgeList> read_graphs(const std::string& file, bool line_graph, int limit)
+{
+    if(file == "-")
+    {
+        Graph6Reader reader(std::cin);
+        return read_stream(reader, line_graph, limit);
+    }
+    Graph6Stream stream(file);
+    return read_stream(stream, line_graph, limit);
+}
+
+// nearest rank percentile of the sorted values
+double percentile(const std::vector<double>& sorted, double p)
+{
+    if(sorted.empty())
+    {
+        return 0;
+    }
+    size_t rank = (size_t)std::ceil(p * sorted.size());
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+BenchRun bench(const std::string& file, const std::vector<EdgeList>& graphs, const BenchConfig& config, bool line_graph,
+               int warmup, int repeat, bool per_graph)
+{
+    CMSatSolver solver;
+    BenchRun run{file, config.name, line_graph};
+    for(size_t i = 0; i < graphs.size(); ++i)
+    {
+        for(int w = 0; w < warmup; ++w)
+        {
+            run_config(config, graphs[i], solver);
+        }
+        // the counters are taken from the first repetition only, the later ones only measure time
+        EcdStats stats;
+        std::vector<double> times;
+        int size = 0;
+        for(int r = 0; r < repeat; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if(r == 0)
+            {
+                EcdStatsScope scope(stats);
+                size = run_config(config, graphs[i], solver);
+            }
+            else
+            {
+                run_config(config, graphs[i], solver);
+            }
+            times.push_back(internal::ecd_seconds_since(start));
+        }
+        std::sort(times.begin(), times.end());
+        double time = times[times.size() / 2];
+
+        run.sizes.push_back(size);
+        run.times.push_back(time);
+        run.nodes += stats.nodes;
+        for(auto& probe : stats.probes)
+        {
+            run.conflicts += std::max(probe.conflicts, 0LL);
+        }
+        if(per_graph)
+        {
+            std::cout << file << " " << config.name << " " << i << " " << size << " " << time << " " << stats.nodes
+                      << std::endl;
+        }
+    }
+
+    std::vector<double> sorted = run.times;
+    std::sort(sorted.begin(), sorted.end());
+    for(double t : sorted)
+    {
+        run.total += t;
+    }
+    run.median = percentile(sorted, 0.5);
+    run.p95 = percentile(sorted, 0.95);
+    return run;
+}
+
+std::string json_string(const std::string& s)
+{
+    std::string quoted = "\"";
+    for(char c : s)
+    {
+        if(c == '"' || c == '\\')
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// every run on its own line, so that the baseline can be read back line by line
+void write_json(std::ostream& out, const std::vector<BenchRun>& runs, int warmup, int repeat)
+{
+    out << std::setprecision(9);
+    out << "{\n  \"warmup\": " << warmup << ",\n  \"repeat\": " << repeat << ",\n  \"runs\": [\n";
+    for(size_t i = 0; i < runs.size(); ++i)
+    {
+        const BenchRun& r = runs[i];
+        out << "    {\"file\": " << json_string(r.file) << ", \"config\": " << json_string(r.config)
+            << ", \"line_graph\": " << (r.line_graph ? "true" : "false") << ", \"graphs\": " << r.sizes.size()
+            << ", \"total\": " << r.total << ", \"median\": " << r.median << ", \"p95\": " << r.p95
+            << ", \"nodes\": " << r.nodes << ", \"conflicts\": " << r.conflicts << ", \"sizes\": [";
+        for(size_t j = 0; j < r.sizes.size(); ++j)
+        {
+            out << (j ? ", " : "") << r.sizes[j];
+        }
+        out << "], \"times\": [";
+        for(size_t j = 0; j < r.times.size(); ++j)
+        {
+            out << (j ? ", " : "") << r.times[j];
+        }
+        out << "]}" << (i + 1 < runs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// the value of "key" in a line written by write_json, up to the next comma or closing bracket
+std::string json_field(const std::string& line, const std::string& key)
+{
+    std::string pattern = "\"" + key + "\": ";
+    size_t pos = line.find(pattern);
+    if(pos == std::string::npos)
+    {
+        throw std::runtime_error("baseline without " + key);
+    }
+    pos += pattern.size();
+    if(line[pos] == '"')
+    {
+        std::string value;
+        for(++pos; pos < line.size() && line[pos] != '"'; ++pos)
+        {
+            if(line[pos] == '\\')
+            {
+                ++pos;
+            }
+            value += line[pos];
+        }
+        return value;
+    }
+    if(line[pos] == '[')
+    {
+        return line.substr(pos + 1, line.find(']', pos) - pos - 1);
+    }
+    return line.substr(pos, line.find_first_of(",}", pos) - pos);
+}
+
+std::string run_key(const std::string& file, const std::string& config, bool line_graph)
+{
+    return file + " " + config + (line_graph ? " -l" : "");
+}
+
+std::map<std::string, BenchRun> read_baseline(const std::string& file)
+{
+    std::ifstream in(file);
+    if(!in)
+    {
+        throw std::runtime_error("cannot open baseline " + file);
+    }
+    std::map<std::string, BenchRun> runs;
+    for(std::string line; std::getline(in, line);)
+    {
+        if(line.find("\"file\": ") == std::string::npos)
+        {
+            continue;
+        }
+        BenchRun r{json_field(line, "file"), json_field(line, "config"), json_field(line, "line_graph") == "true"};
+        r.total = std::stod(json_field(line, "total"));
+        r.nodes = std::stoll(json_field(line, "nodes"));
+        for(auto& size : split(json_field(line, "sizes"), ','))
+        {
+            r.sizes.push_back(std::stoi(size));
+        }
+        runs[run_key(r.file, r.config, r.line_graph)] = r;
+    }
+    return runs;
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        options.add_options()("h, help", "print help")(
+          "f,files", "comma separated graph6 files, - reads stdin", cxxopts::value<std::string>()->default_value("graphs/3regular/12_3_3.g6"))(
+          "l,linegraph", "whether to benchmark the line graphs", cxxopts::value<bool>()->default_value("false"))(
+          "c,configs", "comma separated engine[:encoding[:symmetry[:two]]] or backtracking[:order[:seed]], engines backtracking/sat/sat-incremental/portfolio",
+          cxxopts::value<std::string>()->default_value("backtracking,sat-incremental"))(
+          "warmup", "untimed runs of every graph", cxxopts::value<int>()->default_value("1"))(
+          "repeat", "timed runs of every graph", cxxopts::value<int>()->default_value("5"))(
+          "limit", "only the first graphs of every file, 0 for all", cxxopts::value<int>()->default_value("0"))(
+          "per-graph", "print the size, time and nodes of every graph", cxxopts::value<bool>()->default_value("false"))(
+          "json", "write the results to this file", cxxopts::value<std::string>())(
+          "baseline", "compare the times with this file written by --json", cxxopts::value<std::string>())(
+          "threshold", "relative slowdown against the baseline reported as a regression", cxxopts::value<double>()->default_value("0.1"));
+
+        options.parse_positional({"f"});
+        options.positional_help("<graph files>");
+        auto result = options.parse(argc, argv);
+        if(result.count("help"))
+        {
+            std::cout << options.help() << std::endl;
+            return 0;
+        }
+
+        bool line_graph = result["l"].as<bool>();
+        int warmup = result["warmup"].as<int>();
+        int repeat = std::max(result["repeat"].as<int>(), 1);
+        int limit = result["limit"].as<int>();
+        bool per_graph = result["per-graph"].as<bool>();
+        std::vector<BenchConfig> configs;
+        for(auto& name : split(result["c"].as<std::string>(), ','))
+        {
+            configs.push_back(parse_config(name));
+        }
+        std::map<std::string, BenchRun> baseline;
+        if(result.count("baseline"))
+        {
+            baseline = read_baseline(result["baseline"].as<std::string>());
+        }
+        double threshold = result["threshold"].as<double>();
+
+        bool failed = false;
+        std::vector<BenchRun> runs;
+        for(auto& file : split(result["f"].as<std::string>(), ','))
+        {
+            std::vector<EdgeList> graphs = read_graphs(file, line_graph, limit);
+            size_t first = runs.size();
+            for(auto& config : configs)
+            {
+                BenchRun run = bench(file, graphs, config, line_graph, warmup, repeat, per_graph);
+                std::cout << file << " " << config.name << " graphs=" << run.sizes.size() << " total=" << run.total
+                          << " median=" << run.median << " p95=" << run.p95 << " nodes=" << run.nodes
+                          << " conflicts=" << run.conflicts;
+                // every configuration has to agree with the first one
+                if(runs.size() > first && run.sizes != runs[first].sizes)
+                {
+                    std::cout << " sizes differ from " << configs[0].name;
+                    failed = true;
+                }
+                auto base = baseline.find(run_key(file, config.name, line_graph));
+                if(base != baseline.end())
+                {
+                    double ratio = base->second.total > 0 ? run.total / base->second.total : 1;
+                    std::cout << " baseline=" << base->second.total << " ratio=" << ratio;
+                    if(base->second.sizes != run.sizes)
+                    {
+                        std::cout << " sizes differ from baseline";
+                        failed = true;
+                    }
+                    else if(ratio > 1 + threshold)
+                    {
+                        std::cout << " regression";
+                        failed = true;
+                    }
+                }
+                std::cout << std::endl;
+                runs.push_back(std::move(run));
+            }
+        }
+
+        if(result.count("json"))
+        {
+            std::ofstream out(result["json"].as<std::string>());
+            if(!out)
+            {
+                throw std::runtime_error("cannot write " + result["json"].as<std::string>());
+            }
+            write_json(out, runs, warmup, repeat);
+        }
+        return failed ? 1 : 0;
+    }
+    catch(const cxxopts::exceptions::exception& e)
+    {
+        std::cerr << "error parsing option:" << e.what() << std::endl;
+        exit(1);
+    }
+    catch(const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+}
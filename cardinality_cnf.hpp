@@ -0,0 +1,153 @@
+#ifndef CARDINALITY_CNF_HPP
+#define CARDINALITY_CNF_HPP
+
+#include "flat_cnf.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ba_graph
+{
+// encodings of "at most one of lits is true", lits are literals of FlatCNF. Auxiliary variables are taken from cnf.vars
+enum class AmoEncoding
+{
+    pairwise,    // no auxiliary variables, n*(n-1)/2 clauses
+    sequential,  // sequential counter of Sinz, n-1 auxiliary variables, 3n clauses
+    commander,   // commander encoding of Klieber and Kwon with groups of 3, applied recursively
+    ladder       // ladder encoding of Gent and Nightingale, n-1 auxiliary variables
+};
+
+inline void amo_pairwise(FlatCNF& cnf, const std::vector<uint32_t>& lits)
+{
+    for(size_t i = 0; i < lits.size(); ++i)
+    {
+        for(size_t j = i + 1; j < lits.size(); ++j)
+        {
+            cnf.add({lits[i] ^ 1, lits[j] ^ 1});
+        }
+    }
+}
+
+// at most r of lits are true, sequential counter: s[i][j] is true if at least j+1 of lits[0..i] are true
+inline void at_most_sequential(FlatCNF& cnf, const std::vector<uint32_t>& lits, int r)
+{
+    int n = (int)lits.size();
+    if(n <= r)
+    {
+        return;
+    }
+    if(r == 0)
+    {
+        for(auto l : lits)
+        {
+            cnf.add({l ^ 1});
+        }
+        return;
+    }
+
+    auto s = [&, first = cnf.vars](int i, int j, bool neg) { return FlatCNF::lit(first + i * r + j, neg); };
+    cnf.vars += (n - 1) * r;
+
+    cnf.add({lits[0] ^ 1, s(0, 0, false)});
+    for(int j = 1; j < r; ++j)
+    {
+        cnf.add({s(0, j, true)});
+    }
+    for(int i = 1; i < n - 1; ++i)
+    {
+        cnf.add({lits[i] ^ 1, s(i, 0, false)});
+        cnf.add({s(i - 1, 0, true), s(i, 0, false)});
+        for(int j = 1; j < r; ++j)
+        {
+            cnf.add({lits[i] ^ 1, s(i - 1, j - 1, true), s(i, j, false)});
+            cnf.add({s(i - 1, j, true), s(i, j, false)});
+        }
+        cnf.add({lits[i] ^ 1, s(i - 1, r - 1, true)});
+    }
+    cnf.add({lits[n - 1] ^ 1, s(n - 2, r - 1, true)});
+}
+
+inline void amo_commander(FlatCNF& cnf, const std::vector<uint32_t>& lits)
+{
+    const size_t group = 3;
+    if(lits.size() <= group + 1)
+    {
+        amo_pairwise(cnf, lits);
+        return;
+    }
+
+    std::vector<uint32_t> commanders;
+    std::vector<uint32_t> members;
+    for(size_t g = 0; g < lits.size(); g += group)
+    {
+        members.assign(lits.begin() + g, lits.begin() + std::min(g + group, lits.size()));
+        uint32_t c = FlatCNF::lit(cnf.vars++, false);
+        commanders.push_back(c);
+
+        amo_pairwise(cnf, members);
+        // c is true iff some member is true
+        for(auto l : members)
+        {
+            cnf.add({l ^ 1, c});
+        }
+        cnf.push(FlatCNF::var(c), true);
+        for(auto l : members)
+        {
+            cnf.push(FlatCNF::var(l), FlatCNF::neg(l));
+        }
+        cnf.close();
+    }
+    amo_commander(cnf, commanders);
+}
+
+// a true lits[i] sets y[0..i-1] and clears y[i..n-2], the y form a ladder y[0] >= y[1] >= ...
+inline void amo_ladder(FlatCNF& cnf, const std::vector<uint32_t>& lits)
+{
+    int n = (int)lits.size();
+    if(n <= 1)
+    {
+        return;
+    }
+
+    auto y = [first = cnf.vars](int i, bool neg) { return FlatCNF::lit(first + i, neg); };
+    cnf.vars += n - 1;
+
+    for(int i = 0; i + 1 < n - 1; ++i)
+    {
+        cnf.add({y(i + 1, true), y(i, false)});
+    }
+    // lits[i] -> y[i-1] and not y[i], two true lits[i], lits[j] with i < j would need y[i] and not y[i]
+    for(int i = 0; i < n; ++i)
+    {
+        if(i > 0)
+        {
+            cnf.add({lits[i] ^ 1, y(i - 1, false)});
+        }
+        if(i < n - 1)
+        {
+            cnf.add({lits[i] ^ 1, y(i, true)});
+        }
+    }
+}
+
+inline void at_most_one(FlatCNF& cnf, const std::vector<uint32_t>& lits, AmoEncoding encoding)
+{
+    switch(encoding)
+    {
+    case AmoEncoding::pairwise:
+        amo_pairwise(cnf, lits);
+        break;
+    case AmoEncoding::sequential:
+        at_most_sequential(cnf, lits, 1);
+        break;
+    case AmoEncoding::commander:
+        amo_commander(cnf, lits);
+        break;
+    case AmoEncoding::ladder:
+        amo_ladder(cnf, lits);
+        break;
+    }
+}
+}  // namespace ba_graph
+#endif  // CARDINALITY_CNF_HPP
@@ -1,15 +1,26 @@
 #ifndef BA_GRAPH_INVARIANTS_ECD_HPP
 #define BA_GRAPH_INVARIANTS_ECD_HPP
 
-#include "algorithms/isomorphism/isomorphism.hpp"
 #include "invariants/degree.hpp"
 #include "invariants/distance.hpp"
 #include "operations/basic.hpp"
 #include "operations/line_graph.hpp"
+#include "ecd_blocks.hpp"
+#include "ecd_bounds.hpp"
+#include "ecd_order.hpp"
+#include "ecd_prefilter.hpp"
+#include "ecd_stats.hpp"
+#include "ecd_verify.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
 #include <climits>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -17,221 +28,895 @@ namespace ba_graph
 {
 namespace internal
 {
+// best ecd found so far, it may be shared by several searches of the same graph running in parallel
+class EcdIncumbent
+{
+  public:
+    // accept only colorings of size at most max_size, with first_only the search stops at the first one
+    void limit(int max_size, bool first_only)
+    {
+        min_size.store(max_size == INT_MAX ? INT_MAX : max_size + 1, std::memory_order_relaxed);
+        stop_at_first = first_only;
+    }
+
+    // colorings of this size or larger are not interesting anymore
+    int size() const
+    {
+        return min_size.load(std::memory_order_relaxed);
+    }
+
+    bool found() const
+    {
+        return has_coloring.load(std::memory_order_relaxed);
+    }
+
+    // no ecd can be smaller than lower, the search stops when it finds one of this size
+    void setLowerBound(int lower)
+    {
+        lower_bound = lower;
+    }
+
+    // the search is abandoned once *stop is set by another thread, its result is then meaningless
+    void cancelOn(const std::atomic<bool>* stop)
+    {
+        cancel = stop;
+    }
+
+    // the search can stop
+    bool done() const
+    {
+        return (found() && (stop_at_first || size() <= lower_bound)) || cancelled();
+    }
+
+    bool cancelled() const
+    {
+        return cancel && cancel->load(std::memory_order_relaxed);
+    }
+
+    // remember the coloring if it is smaller than the current one
+    void offer(int size, const std::vector<int>& coloring)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(size < min_size.load(std::memory_order_relaxed))
+        {
+            min_coloring = coloring;
+            min_size.store(size, std::memory_order_relaxed);
+            has_coloring.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    const std::vector<int>& coloring() const
+    {
+        return min_coloring;
+    }
+
+  private:
+    std::atomic<int> min_size{INT_MAX};
+    std::atomic<bool> has_coloring{false};
+    bool stop_at_first = false;
+    int lower_bound = 0;
+    const std::atomic<bool>* cancel = nullptr;
+    std::mutex mutex;
+    std::vector<int> min_coloring;
+};
+
+// subtree of the search: partial coloring and the vertex whose cycle is being built (-1 if a new cycle should be started)
+struct EcdTask
+{
+    std::vector<int> coloring;
+    int cur_size;
+    int vert;
+    int depth;  // number of closed cycles
+};
+
+// receives the subtrees which the search hands over to other workers instead of exploring them itself
+class EcdSplitter
+{
+  public:
+    virtual ~EcdSplitter() = default;
+    virtual bool wantsTask(int depth) = 0;
+    virtual void push(EcdTask task) = 0;
+};
+
 class Ecd
 {
   public:
-    Ecd(const Graph& g) : g(g), lg(line_graph(g)), edge_to_number(line_graph_with_map(g).second)
+    typedef EcdLineGraph::Word Word;
+
+    // with first_only the search stops at the first ecd of size at most max_size instead of looking for the minimal one,
+    // setting *stop or running out of max_nodes nodes interrupts the search
+    Ecd(const Graph& g, int max_size = INT_MAX, bool first_only = false, const std::atomic<bool>* stop = nullptr,
+        const EcdOrdering& ordering = {}, long long max_nodes = LLONG_MAX)
+        : Ecd(EcdLineGraph(g), own_best, nullptr, &g, ordering)
+    {
+        search(max_size, first_only, stop, max_nodes);
+    }
+
+    Ecd(const EdgeList& g, int max_size = INT_MAX, bool first_only = false, const std::atomic<bool>* stop = nullptr,
+        const EcdOrdering& ordering = {}, long long max_nodes = LLONG_MAX)
+        : Ecd(EcdLineGraph(g), own_best, nullptr, nullptr, ordering)
     {
-        std::vector<Number> nums = lg.list(RP::all(), RT::n());
-        uncolored.insert(nums.begin(), nums.end());
-        min_ecd_size = INT_MAX;
-        has_ecd = false;
-        coloring.resize(max_number(lg).to_int() + 1, -1);
+        search(max_size, first_only, stop, max_nodes);
+    }
+
+    // prepare the search without running it, subtrees are then explored by run()
+    Ecd(const Graph& g, EcdIncumbent& best, EcdSplitter* splitter = nullptr) : Ecd(EcdLineGraph(g), best, splitter, &g) {}
+
+    // g is only needed by getEcd. Subtrees run by run() keep the random order of the seed, they are not restarted
+    Ecd(EcdLineGraph graph, EcdIncumbent& best, EcdSplitter* splitter = nullptr, const Graph* g = nullptr,
+        const EcdOrdering& ordering = {})
+        : g(g), lg(std::move(graph)), best(best), splitter(splitter), ordering(ordering)
+    {
+        if(ecd_prefilter(lg) != EcdFilter::none)
+        {
+            return;
+        }
+        feasible = true;
+
+        int m = lg.size();
+        words = lg.wordCount();
+        coloring.resize(m, -1);
+        // every cycle has at least 2 edges, so there are at most m/2 color classes plus the one being opened
+        colors = m + 2;
+        class_words = (colors / 2 + EcdLineGraph::word_bits - 1) / EcdLineGraph::word_bits;
+        at_vertex.resize((size_t)lg.order() * colors, 0);
+        full.resize((size_t)lg.order() * class_words, 0);
+        colored_at.resize(lg.order(), 0);
+        uncolored.resize(words, 0);
+        for(int e = 0; e < m; ++e)
+        {
+            EcdLineGraph::set(uncolored.data(), e);
+        }
+        setOrder(ecd_edge_order(lg, ordering.order, ordering.seed));
+        buildNeighbours();
+    }
+
+    Ecd(const Ecd&) = delete;
+    Ecd& operator=(const Ecd&) = delete;
+
+    ~Ecd()
+    {
+        if(stats_target)
+        {
+            stats_target->merge(counters);
+        }
+    }
 
-        if(g.contains([](const Rotation& r) -> bool { return r.degree() & 1; }) || g.contains(RP::all(), IP::loop()) || (g.size() & 1))
+    // explore the subtree of the task, the state is cleared afterwards so the next task can be run
+    void run(const EcdTask& task)
+    {
+        if(!feasible || task.cur_size >= best.size())
         {
             return;
         }
+        auto start = std::chrono::steady_clock::now();
+
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            if(task.coloring[e] != -1)
+            {
+                colorVert(e, task.coloring[e]);
+            }
+        }
+        depth = task.depth;
 
-        startCycle(0);
+        if(task.vert == -1)
+        {
+            dispatch([&](auto deg) { startCycle<deg.value>(task.cur_size); });
+        }
+        else
+        {
+            dispatch([&](auto deg) { findCycle<deg.value>(task.vert, task.coloring[task.vert], task.cur_size); });
+        }
+        if(stats_target)
+        {
+            counters.search_time += ecd_seconds_since(start);
+        }
+
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            if(task.coloring[e] != -1)
+            {
+                uncolorVert(e);
+            }
+        }
+    }
+
+    // seed the incumbent with the greedy ecd and let the search stop at the lower bound,
+    // returns false if there cannot be an ecd within the limit of the incumbent
+    bool applyBounds()
+    {
+        auto start = std::chrono::steady_clock::now();
+        EcdBounds bounds = ecd_bounds(lg);
+        if(stats_target)
+        {
+            counters.bounds_time += ecd_seconds_since(start);
+        }
+        best.setLowerBound(bounds.lower);
+        if(bounds.lower >= best.size())
+        {
+            return false;
+        }
+        if(bounds.witnessed)
+        {
+            best.offer(bounds.upper, bounds.coloring);
+        }
+        return true;
+    }
+
+    // graph passed the parity checks, so the search has to be run to decide whether there is an ecd
+    bool canHaveEcd() const
+    {
+        return feasible;
+    }
+
+    int edgeCount() const
+    {
+        return lg.size();
     }
 
     // construct each ecd color class based on the minimal ecd size edge coloring
     std::vector<Graph> getEcd(Factory& f = static_factory)
     {
-        if(!has_ecd)
+        if(!best.found() || !g)
         {
             return {};
         }
 
-        std::vector<Graph> subgraphs;
-        for(int i = 0; i < getSize(); ++i)
+        return ecd_subgraphs_from_coloring(*g, lg, best.coloring(), getSize(), f);
+    }
+
+    int getSize() const
+    {
+        return !best.found() ? -1 : best.size();
+    }
+
+    // the search did not complete, getSize is then only an upper bound
+    bool interrupted() const
+    {
+        return out_of_nodes || cancelled;
+    }
+
+  protected:
+    const Graph* g;
+    const EcdLineGraph lg;  // for simplicity, we will be assigning vertices of a line graph to cycles
+    EcdIncumbent own_best;
+    EcdIncumbent& best;
+    EcdSplitter* splitter;
+    EcdOrdering ordering;
+    bool feasible = false;
+    int depth = 0;  // number of closed cycles on the current branch
+    int words = 0;
+    std::vector<int> coloring;  // to which color class does vertex belong, color class c consists of vertex colors 2*c, 2*c+1
+    std::vector<Word> uncolored;
+    // counters of the coloring at the vertices of the graph, changed by colorVert and reverted by uncolorVert
+    int colors = 0;
+    int class_words = 0;
+    std::vector<int> at_vertex;  // number of edges of each vertex color at each vertex
+    std::vector<Word> full;      // bitset of the color classes with two (or more) edges at each vertex
+    std::vector<int> colored_at;  // number of colored edges at each vertex
+    // edges in the order cycles are started from, rank is its inverse and pending the bitset of the uncolored ranks
+    std::vector<int> order;
+    std::vector<int> rank;
+    std::vector<Word> pending;
+    long long nodes_left = LLONG_MAX;  // nodes of the current run, limited by the restarts and by max_nodes
+    bool out_of_nodes = false;
+    bool cancelled = false;
+    // for a simple regular graph of degree 4 or 6 the 2*(degree-1) edges adjacent to each edge in increasing order,
+    // the search is then compiled for that degree and scans these instead of the bitsets
+    int fixed_degree = 0;
+    std::vector<int> neighbours;
+    EcdStats* stats_target = ecd_stats();  // counters are added there when the search is destroyed
+    EcdStats counters;
+
+    void buildNeighbours()
+    {
+        int d = lg.order() ? lg.degree(0) : 0;
+        if((d != 4 && d != 6) || lg.hasParallelEdge())
         {
-            subgraphs.emplace_back(createG(f));
+            return;
+        }
+        for(int v = 0; v < lg.order(); ++v)
+        {
+            if(lg.degree(v) != d)
+            {
+                return;
+            }
+        }
+        fixed_degree = d;
+        neighbours.reserve((size_t)lg.size() * 2 * (d - 1));
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            const Word* star1 = lg.star(lg.end(e, 0));
+            const Word* star2 = lg.star(lg.end(e, 1));
+            for(int w = 0; w < words; ++w)
+            {
+                Word adj = star1[w] | star2[w];
+                while(adj)
+                {
+                    int f = w * EcdLineGraph::word_bits + std::countr_zero(adj);
+                    adj &= adj - 1;
+                    if(f != e)
+                    {
+                        neighbours.push_back(f);
+                    }
+                }
+            }
         }
+    }
 
-        for(auto& e : g.list(RP::all(), IP::primary(), IT::e()))
+    // calls f with std::integral_constant of the degree the search is compiled for, 0 is the generic one
+    template <typename F>
+    void dispatch(F f)
+    {
+        switch(fixed_degree)
         {
-            Graph& subg = subgraphs[min_ecd_coloring[edge_to_number[e].to_int()] / 2];
+            case 4:
+                f(std::integral_constant<int, 4>());
+                break;
+            case 6:
+                f(std::integral_constant<int, 6>());
+                break;
+            default:
+                f(std::integral_constant<int, 0>());
+        }
+    }
 
-            if(!subg.contains(RP::v(e.v1())))
+    void search(int max_size, bool first_only, const std::atomic<bool>* stop, long long max_nodes)
+    {
+        own_best.limit(max_size, first_only);
+        own_best.cancelOn(stop);
+        if(feasible && applyBounds())
+        {
+            auto start = std::chrono::steady_clock::now();
+            if(ordering.order == EcdOrder::random)
+            {
+                searchWithRestarts(max_nodes);
+            }
+            else
             {
-                addV(subg, e.v1(), g.find(RP::v(e.v1()))->n(), f);
+                nodes_left = max_nodes;
+                dispatch([&](auto deg) { startCycle<deg.value>(0); });
+                out_of_nodes = nodes_left < 0 && !best.done();
+                nodes_left = LLONG_MAX;
             }
-            if(!subg.contains(RP::v(e.v2())))
+            cancelled = best.cancelled();
+            if(stats_target)
             {
-                addV(subg, e.v2(), g.find(RP::v(e.v2()))->n(), f);
+                counters.search_time += ecd_seconds_since(start);
             }
-            addE(subg, e, f);
         }
+    }
 
-        return subgraphs;
+    // a run with a new random order and twice the nodes after each one which used up its nodes. The incumbent is
+    // kept between the runs and the last one completes, so the result is exact unless max_nodes run out first
+    void searchWithRestarts(long long max_nodes)
+    {
+        long long limit = std::max(ordering.restart_nodes, 1LL);
+        for(uint32_t run = 0;; ++run)
+        {
+            setOrder(ecd_edge_order(lg, EcdOrder::random, ordering.seed + run));
+            long long run_nodes = std::min(limit, max_nodes);
+            nodes_left = run_nodes;
+            dispatch([&](auto deg) { startCycle<deg.value>(0); });
+            if(nodes_left >= 0 || best.done())
+            {
+                break;
+            }
+            if(run_nodes == max_nodes)
+            {
+                out_of_nodes = true;
+                break;
+            }
+            max_nodes -= run_nodes;
+            limit = limit > LLONG_MAX / 2 ? LLONG_MAX : 2 * limit;
+        }
+        nodes_left = LLONG_MAX;
     }
 
-    int getSize() const
+    void setOrder(std::vector<int> edges)
     {
-        return !has_ecd ? -1 : min_ecd_size;
+        order = std::move(edges);
+        rank.resize(order.size());
+        pending.assign(words, 0);
+        for(int r = 0; r < (int)order.size(); ++r)
+        {
+            rank[order[r]] = r;
+            if(coloring[order[r]] == -1)
+            {
+                EcdLineGraph::set(pending.data(), r);
+            }
+        }
     }
 
-  protected:
-    const Graph& g;
-    const Graph lg;  // for simplicity, we will be assigning vertices of a line graph to cycles
-    int min_ecd_size;
-    bool has_ecd;
-    std::vector<int> coloring;  // to which color class does vertex belong, color class c consists of vertex colors 2*c, 2*c+1
-    std::vector<int> min_ecd_coloring;
-    std::set<Number> uncolored;
-    std::map<Edge, Number> edge_to_number;  // conversion from line graph
+    // the search returns from every node once the incumbent is done or the run has used up its nodes
+    bool stopped()
+    {
+        return best.done() || --nodes_left < 0;
+    }
 
-    // try to assign vertex to a cycle of color class col/2
-    void assignCol(Number vert, int col, int cur_size)
+    // counting for EcdStats, compiled out with ECD_NO_STATS
+    static void count(long long& counter)
     {
-        coloring[vert.to_int()] = col;
-        uncolored.erase(vert);
+        if constexpr(ecd_stats_enabled)
+        {
+            counter++;
+        }
+    }
 
-        findCycle(vert, col, cur_size);
+    void countDepth()
+    {
+        if constexpr(ecd_stats_enabled)
+        {
+            counters.max_depth = std::max(counters.max_depth, depth);
+        }
+    }
 
-        coloring[vert.to_int()] = -1;
-        uncolored.insert(vert);
+    int& atVertex(int v, int col)
+    {
+        return at_vertex[(size_t)v * colors + col];
     }
 
-    // find an even cycle using colors col, col+1 alternately. The cycle will belong to color class col/2
-    void findCycle(Number cur_vert, int col, int cur_size)
+    Word* fullAt(int v)
     {
-        int oth_col = (col & 1 ? col - 1 : col + 1);
-        int cnt_oth_col = 0;
+        return &full[(size_t)v * class_words];
+    }
 
-        for(auto& i : lg[cur_vert])
+    void colorVert(int vert, int col)
+    {
+        coloring[vert] = col;
+        EcdLineGraph::reset(uncolored.data(), vert);
+        EcdLineGraph::reset(pending.data(), rank[vert]);
+        for(int side = 0; side < 2; ++side)
         {
-            Number neigh = i.n2();
+            int v = lg.end(vert, side);
+            colored_at[v]++;
+            if(++atVertex(v, col) + atVertex(v, col ^ 1) == 2)
+            {
+                EcdLineGraph::set(fullAt(v), col / 2);
+            }
+        }
+    }
 
-            if(coloring[neigh.to_int()] == -1)
+    void uncolorVert(int vert)
+    {
+        int col = coloring[vert];
+        for(int side = 0; side < 2; ++side)
+        {
+            int v = lg.end(vert, side);
+            colored_at[v]--;
+            if(--atVertex(v, col) + atVertex(v, col ^ 1) == 1)
             {
-                continue;
+                EcdLineGraph::reset(fullAt(v), col / 2);
             }
-            // in an even cycle both my neighbors have to be of different parity
-            if(coloring[neigh.to_int()] == col)
+        }
+        EcdLineGraph::set(uncolored.data(), vert);
+        EcdLineGraph::set(pending.data(), rank[vert]);
+        coloring[vert] = -1;
+    }
+
+    // whether some of the classes 0..classes-1 has at most one edge at both u and v
+    bool hasFreeClass(int u, int v, int classes)
+    {
+        const Word* full_u = fullAt(u);
+        const Word* full_v = fullAt(v);
+        for(int w = 0; w * EcdLineGraph::word_bits < classes; ++w)
+        {
+            Word free = ~(full_u[w] | full_v[w]);
+            int rest = classes - w * EcdLineGraph::word_bits;
+            if(rest < EcdLineGraph::word_bits)
             {
-                return;
+                free &= (Word(1) << rest) - 1;
+            }
+            if(free)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // forward checking: once no new class may be opened, each uncolored edge needs a class with at most one edge at
+    // both its ends, otherwise its cycle cannot be completed. Only the uncolored edges at the vertex v are checked
+    bool coverableAt(int v, int cur_size)
+    {
+        const Word* star = lg.star(v);
+        for(int w = 0; w < words; ++w)
+        {
+            Word cand = star[w] & uncolored[w];
+            while(cand)
+            {
+                int e = w * EcdLineGraph::word_bits + std::countr_zero(cand);
+                cand &= cand - 1;
+                int other = lg.end(e, 0) == v ? lg.end(e, 1) : lg.end(e, 0);
+                if(!hasFreeClass(v, other, cur_size))
+                {
+                    return false;
+                }
             }
-            if(coloring[neigh.to_int()] == oth_col)
+        }
+        return true;
+    }
+
+    // the ends of vert which its class col/2 has just filled up are checked, all vertices if all is set
+    bool forwardCheck(int vert, int col, int cur_size, bool all = false)
+    {
+        if(cur_size + 1 < best.size())
+        {
+            return true;
+        }
+        if(all)
+        {
+            for(int v = 0; v < lg.order(); ++v)
             {
-                cnt_oth_col++;
-                // exactly 2 of my neighbors have to be of different parity
-                if(cnt_oth_col > 2)
+                if(!coverableAt(v, cur_size))
                 {
-                    return;
+                    return false;
                 }
             }
+            return true;
+        }
+        for(int side = 0; side < 2; ++side)
+        {
+            int v = lg.end(vert, side);
+            if(EcdLineGraph::test(fullAt(v), col / 2) && !coverableAt(v, cur_size))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // try to assign vertex to a cycle of color class col/2
+    template <int Deg>
+    void assignCol(int vert, int col, int cur_size)
+    {
+        colorVert(vert, col);
+        findCycle<Deg>(vert, col, cur_size);
+        uncolorVert(vert);
+    }
+
+    // start a cycle of the color class col/2 in vert, or hand this subtree over to an idle worker
+    template <int Deg>
+    void branch(int vert, int col, int cur_size)
+    {
+        if(splitter && splitter->wantsTask(depth))
+        {
+            EcdTask task{coloring, cur_size, vert, depth};
+            task.coloring[vert] = col;
+            splitter->push(std::move(task));
+            return;
+        }
+        assignCol<Deg>(vert, col, cur_size);
+    }
+
+    // find an even cycle using colors col, col+1 alternately. The cycle will belong to color class col/2
+    template <int Deg>
+    void findCycle(int cur_vert, int col, int cur_size)
+    {
+        if(stopped())
+        {
+            count(counters.prune_done);
+            return;
+        }
+        count(counters.nodes);
+
+        int oth_col = col ^ 1;
+        int u = lg.end(cur_vert, 0);
+        int v = lg.end(cur_vert, 1);
+        // neighbours of each color from the counters at the ends, cur_vert itself is counted at both of them and a
+        // parallel edge is a neighbour through both ends
+        int cnt_col = atVertex(u, col) + atVertex(v, col) - 2;
+        int cnt_oth_col = atVertex(u, oth_col) + atVertex(v, oth_col);
+        // in an even cycle both my neighbors have to be of different parity, exactly 2 of them
+        if(cnt_col > 0 || cnt_oth_col > 2)
+        {
+            count(counters.prune_conflict);
+            return;
+        }
+        if(!forwardCheck(cur_vert, col, cur_size))
+        {
+            count(counters.prune_forward);
+            return;
         }
         // found a good even cycle
         if(cnt_oth_col == 2)
         {
-            startCycle(cur_size);
+            depth++;
+            countDepth();
+            startCycle<Deg>(cur_size);
+            depth--;
             return;
         }
 
-        for(auto& i : lg[cur_vert])
+        if constexpr(Deg > 0)
         {
-            Number neigh = i.n2();
-            if(coloring[neigh.to_int()] == -1)
+            // fixed number of neighbours, the loop is unrolled
+            constexpr int k = 2 * (Deg - 1);
+            const int* nbrs = &neighbours[(size_t)cur_vert * k];
+            for(int i = 0; i < k; ++i)
             {
-                assignCol(neigh, oth_col, cur_size);
+                if(coloring[nbrs[i]] == -1)
+                {
+                    assignCol<Deg>(nbrs[i], oth_col, cur_size);
+                }
+            }
+            return;
+        }
+
+        const Word* star1 = lg.star(u);
+        const Word* star2 = lg.star(v);
+        for(int w = 0; w < words; ++w)
+        {
+            Word cand = (star1[w] | star2[w]) & uncolored[w];
+            while(cand)
+            {
+                int neigh = w * EcdLineGraph::word_bits + std::countr_zero(cand);
+                cand &= cand - 1;
+                assignCol<Deg>(neigh, oth_col, cur_size);
             }
         }
     }
 
+    template <int Deg>
     void startCycle(int cur_size)
     {
-        if(uncolored.empty())
+        if(stopped())
         {
-            min_ecd_size = cur_size;
-            min_ecd_coloring = coloring;
-            has_ecd = true;
+            count(counters.prune_done);
             return;
         }
+        count(counters.nodes);
 
-        Number start_vert = *uncolored.begin();
+        int start_vert = nextEdge();
+        if(start_vert == -1)
+        {
+            best.offer(cur_size, coloring);
+            return;
+        }
+        // the incumbent may have improved since the last check, so every uncolored edge is checked
+        if(!forwardCheck(start_vert, 0, cur_size, true))
+        {
+            count(counters.prune_forward);
+            return;
+        }
 
         // try to assign vertex to some existing color class
         for(int c = 0; c < cur_size; ++c)
         {
-            assignCol(start_vert, 2 * c, cur_size);
+            branch<Deg>(start_vert, 2 * c, cur_size);
         }
 
         // assign to a new color class
         cur_size++;
-        if(cur_size >= min_ecd_size)
+        if(cur_size >= best.size())
         {
+            count(counters.prune_bound);
             return;
         }
 
-        assignCol(start_vert, 2 * (cur_size - 1), cur_size);
+        branch<Deg>(start_vert, 2 * (cur_size - 1), cur_size);
+    }
+
+    // the uncolored edge starting the next cycle, -1 if there is none
+    int nextEdge() const
+    {
+        if(ordering.order == EcdOrder::constrained)
+        {
+            int next = -1;
+            int most = -1;
+            for(int w = 0; w < words; ++w)
+            {
+                Word cand = uncolored[w];
+                while(cand)
+                {
+                    int e = w * EcdLineGraph::word_bits + std::countr_zero(cand);
+                    cand &= cand - 1;
+                    int colored = colored_at[lg.end(e, 0)] + colored_at[lg.end(e, 1)];
+                    if(colored > most)
+                    {
+                        next = e;
+                        most = colored;
+                    }
+                }
+            }
+            return next;
+        }
+        for(int w = 0; w < words; ++w)
+        {
+            if(pending[w])
+            {
+                return order[w * EcdLineGraph::word_bits + std::countr_zero(pending[w])];
+            }
+        }
+        return -1;
     }
 };
 }  // namespace internal
 
-// minimal size of the Ecd, if there is none, return -1
-inline int ecd_size(const Graph& g)
+// minimal size of the Ecd, if there is none, return -1. The blocks of g are searched separately
+inline int ecd_size(const EdgeList& g, const EcdOrdering& ordering = {})
+{
+    return internal::ecd_size_by_blocks(g, [&](const EdgeList& block) {
+        internal::Ecd ecd(block, INT_MAX, false, nullptr, ordering);
+        return ecd.getSize();
+    });
+}
+
+inline int ecd_size(const Graph& g, const EcdOrdering& ordering = {})
+{
+    return ecd_size(edge_list(g), ordering);
+}
+
+// whether there is an ecd, the search stops at the first one found
+inline bool has_ecd(const Graph& g)
+{
+    internal::Ecd ecd(g, INT_MAX, true);
+
+    return ecd.getSize() != -1;
+}
+
+inline bool has_ecd(const EdgeList& g)
+{
+    internal::Ecd ecd(g, INT_MAX, true);
+
+    return ecd.getSize() != -1;
+}
+
+// whether there is an ecd of size at most k, the search stops at the first one found
+inline bool has_ecd_at_most(const Graph& g, int k)
 {
-    internal::Ecd ecd(g);
+    if(k < 0)
+    {
+        return false;
+    }
+    internal::Ecd ecd(g, k, true);
 
-    return ecd.getSize();
+    return ecd.getSize() != -1;
+}
+
+// minimal size of the Ecd found by iterative deepening, if there is none, return -1. The size of the first ecd found
+// bounds the search, then k = 0, 1, 2, ... are tried with has_ecd_at_most until one succeeds
+inline int ecd_size_iterative(const Graph& g)
+{
+    internal::Ecd first(g, INT_MAX, true);
+    int upper = first.getSize();
+
+    for(int k = 0; k < upper; ++k)
+    {
+        if(has_ecd_at_most(g, k))
+        {
+            return k;
+        }
+    }
+    return upper;
 }
 
 // get the subgraphs which make up the ecd, length of the vector is number of
 // color classes. If no ecd, returns {}
-inline std::vector<Graph> ecd_subgraphs(const Graph& g, Factory& f = static_factory)
+inline std::vector<Graph> ecd_subgraphs(const Graph& g, Factory& f = static_factory, const EcdOrdering& ordering = {})
 {
-    internal::Ecd ecd(g);
+    internal::Ecd ecd(g, INT_MAX, false, nullptr, ordering);
 
     return ecd.getEcd(f);
 }
 
-// check whether we have an ecd decomposition of the given graph
+// check whether we have an ecd decomposition of the given graph. Ends of the edges of the subgraphs are matched to
+// the vertices of g by their numbers, which ecd_subgraphs keeps, and by a map for vertices numbered otherwise.
+// An edge of g in a subgraph takes itself, the other edges take an unused edge of g with the same ends, then the
+// classes are checked by is_ecd_coloring without building any graph or testing isomorphism
 inline bool is_ecd(const Graph& g, std::vector<Graph>& subgraphs)
 {
-    std::vector<Vertex> vert_set;
-    std::vector<Edge> edge_set;
-
-    for(auto& subg : subgraphs)
+    int max_num = -1;
+    for(auto& r : g)
+    {
+        max_num = std::max(max_num, r.n().to_int());
+    }
+    std::vector<int> by_number(max_num + 1, -1);
+    std::vector<Vertex> vertices;
+    for(auto& r : g)
     {
-        if(min_deg(subg) != 2 || max_deg(subg) != 2)
+        by_number[r.n().to_int()] = (int)vertices.size();
+        vertices.push_back(r.v());
+    }
+    std::map<Vertex, int> by_vertex;
+    auto index = [&](Number n, const Vertex& v) {
+        int i = n.to_int() >= 0 && n.to_int() <= max_num ? by_number[n.to_int()] : -1;
+        if(i >= 0 && vertices[i] == v)
         {
-            return false;
+            return i;
         }
-        auto comps = components(subg);
-
-        for(auto& comp : comps)
+        if(by_vertex.empty())
         {
-            if(comp.size() & 1)
+            for(int j = 0; j < (int)vertices.size(); ++j)
             {
-                return false;
+                by_vertex.emplace(vertices[j], j);
             }
         }
+        auto it = by_vertex.find(v);
+        return it == by_vertex.end() ? -1 : it->second;
+    };
 
-        std::vector<Vertex> subg_vert = subg.list(RP::all(), RT::v());
-        std::vector<Edge> subg_edg = subg.list(RP::all(), IP::primary(), IT::e());
-
-        vert_set.insert(vert_set.begin(), subg_vert.begin(), subg_vert.end());
-        edge_set.insert(edge_set.end(), subg_edg.begin(), subg_edg.end());
+    EdgeList list{(int)vertices.size(), {}};
+    std::vector<Edge> edges;
+    for(auto& r : g)
+    {
+        for(auto& i : r)
+        {
+            if(i.is_primary())
+            {
+                list.edges.emplace_back(by_number[i.n1().to_int()], by_number[i.n2().to_int()]);
+                edges.push_back(i.e());
+            }
+        }
     }
+    internal::EcdEdgeBuckets buckets(list);
 
-    std::sort(vert_set.begin(), vert_set.end());
-    std::sort(edge_set.begin(), edge_set.end());
-
-    if(std::adjacent_find(edge_set.begin(), edge_set.end()) != edge_set.end())
+    struct Used
+    {
+        Edge e;
+        int u, v, c;
+    };
+    std::vector<Used> other;  // edges of the subgraphs which are not edges of g, none for the ones of ecd_subgraphs
+    std::vector<int> edge_class(list.size(), -1);
+    int matched = 0;
+    for(int c = 0; c < (int)subgraphs.size(); ++c)
+    {
+        for(auto& r : subgraphs[c])
+        {
+            for(auto& i : r)
+            {
+                if(!i.is_primary())
+                {
+                    continue;
+                }
+                int u = index(i.n1(), i.v1()), v = index(i.n2(), i.v2());
+                if(u < 0 || v < 0)
+                {
+                    return false;
+                }
+                int e = buckets.find(u, v, [&](int e) { return edges[e] == i.e(); });
+                if(e < 0)
+                {
+                    other.push_back({i.e(), u, v, c});
+                    continue;
+                }
+                // the same edge cannot be used in several subgraphs
+                if(buckets.isTaken(e))
+                {
+                    return false;
+                }
+                buckets.setTaken(e);
+                edge_class[e] = c;
+                matched++;
+            }
+        }
+    }
+    std::sort(other.begin(), other.end(), [](const Used& a, const Used& b) { return a.e < b.e; });
+    if(std::adjacent_find(other.begin(), other.end(), [](const Used& a, const Used& b) { return a.e == b.e; }) !=
+       other.end())
     {
         return false;
     }
-
-    vert_set.erase(std::unique(vert_set.begin(), vert_set.end()), vert_set.end());
-
-    Graph g_2(createG());
-    addMultipleV(g_2, vert_set);
-    addMultipleE(g_2, edge_set);
-
-    return are_isomorphic(g, g_2);
+    for(auto& used : other)
+    {
+        int e = buckets.take(used.u, used.v, [&](int e) {
+            auto [a, b] = list.edges[e];
+            return std::max(a, b) == std::max(used.u, used.v);
+        });
+        if(e < 0)
+        {
+            return false;
+        }
+        edge_class[e] = used.c;
+        matched++;
+    }
+    if(matched != list.size())
+    {
+        return false;
+    }
+    return internal::is_ecd_coloring(list.order(), list.size(), edge_class, (int)subgraphs.size(),
+                                     [&](int e) { return list.edges[e]; });
 }
 }  // namespace ba_graph
 #endif
@@ -0,0 +1,257 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_AUTOMORPHISMS_HPP
+#define BA_GRAPH_INVARIANTS_ECD_AUTOMORPHISMS_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+namespace internal
+{
+// generators of the automorphism group of g, as permutations of the edges of lg. Vertex automorphisms are found
+// level by level as in Schreier-Sims: on level i the vertices 0..i-1 are fixed and i is mapped to every vertex not
+// yet in its orbit by a backtracking search. Swaps of parallel edges are added as well. The searches share a node
+// limit, after it is spent only the generators found so far are kept, which is still a subgroup.
+class EcdAutomorphisms
+{
+  public:
+    EcdAutomorphisms(const EcdLineGraph& lg, long long node_limit = 100000) : lg(lg), n(lg.order()), nodes(node_limit)
+    {
+        mult.assign((size_t)n * n, 0);
+        pair_edges.resize((size_t)n * n);
+        pair_pos.resize(lg.size());
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            int u = lg.end(e, 0), v = lg.end(e, 1);
+            mult[u * n + v]++;
+            if(u != v)
+            {
+                mult[v * n + u]++;
+            }
+            auto& list = pair_edges[std::min(u, v) * n + std::max(u, v)];
+            pair_pos[e] = (int)list.size();
+            list.push_back(e);
+        }
+
+        for(auto& list : pair_edges)
+        {
+            for(size_t i = 1; i < list.size(); ++i)
+            {
+                std::vector<int> p(lg.size());
+                std::iota(p.begin(), p.end(), 0);
+                std::swap(p[list[i - 1]], p[list[i]]);
+                gens.push_back(std::move(p));
+            }
+        }
+
+        refine();
+        searchGenerators();
+    }
+
+    const std::vector<std::vector<int>>& generators() const
+    {
+        return gens;
+    }
+
+  private:
+    const EcdLineGraph& lg;
+    int n;
+    long long nodes;
+    std::vector<int> mult;  // number of edges between u and v is mult[u*n+v]
+    std::vector<std::vector<int>> pair_edges;
+    std::vector<int> pair_pos;  // position of the edge among the edges with the same ends
+    std::vector<int> color;     // stable coloring by color refinement, automorphisms keep it
+    std::vector<std::vector<int>> gens;
+
+    std::vector<int> order;
+    std::vector<int> map;
+    std::vector<bool> used;
+
+    void refine()
+    {
+        color.assign(n, 0);
+        for(int v = 0; v < n; ++v)
+        {
+            color[v] = lg.degree(v);
+        }
+        int classes = 0;
+        while(true)
+        {
+            std::map<std::vector<int>, int> ids;
+            std::vector<int> next(n);
+            for(int v = 0; v < n; ++v)
+            {
+                std::vector<int> sig = {color[v]};
+                std::vector<int> nbrs;
+                for(int u = 0; u < n; ++u)
+                {
+                    if(mult[v * n + u])
+                    {
+                        nbrs.push_back(color[u] * (lg.size() + 1) + mult[v * n + u]);
+                    }
+                }
+                std::sort(nbrs.begin(), nbrs.end());
+                sig.insert(sig.end(), nbrs.begin(), nbrs.end());
+                next[v] = ids.emplace(std::move(sig), (int)ids.size()).first->second;
+            }
+            color = std::move(next);
+            if((int)ids.size() == classes)
+            {
+                break;
+            }
+            classes = (int)ids.size();
+        }
+    }
+
+    static int find(std::vector<int>& parent, int v)
+    {
+        while(parent[v] != v)
+        {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    }
+
+    void searchGenerators()
+    {
+        // orbits of the group generated by the generators found on the levels >= i
+        std::vector<int> parent(n);
+        std::iota(parent.begin(), parent.end(), 0);
+        for(int i = n - 1; i >= 0; --i)
+        {
+            levelOrder(i);
+            for(int v = i + 1; v < n; ++v)
+            {
+                if(color[v] != color[i] || find(parent, v) == find(parent, i))
+                {
+                    continue;
+                }
+                map.assign(n, -1);
+                used.assign(n, false);
+                for(int u = 0; u < i; ++u)
+                {
+                    map[u] = u;
+                    used[u] = true;
+                }
+                if(!consistent(i, v))
+                {
+                    continue;
+                }
+                map[i] = v;
+                used[v] = true;
+                if(!extend(i + 1))
+                {
+                    if(nodes < 0)
+                    {
+                        return;
+                    }
+                    continue;
+                }
+                for(int u = 0; u < n; ++u)
+                {
+                    parent[find(parent, u)] = find(parent, map[u]);
+                }
+                gens.push_back(edgePermutation());
+            }
+        }
+    }
+
+    // the fixed vertices 0..i first, then the rest in bfs order so that each vertex has mapped neighbours
+    void levelOrder(int i)
+    {
+        order.clear();
+        std::vector<bool> seen(n, false);
+        for(int u = 0; u <= i; ++u)
+        {
+            order.push_back(u);
+            seen[u] = true;
+        }
+        for(size_t head = 0; (int)order.size() < n; ++head)
+        {
+            if(head == order.size())
+            {
+                int u = (int)(std::find(seen.begin(), seen.end(), false) - seen.begin());
+                order.push_back(u);
+                seen[u] = true;
+            }
+            int x = order[head];
+            for(int u = 0; u < n; ++u)
+            {
+                if(!seen[u] && mult[x * n + u])
+                {
+                    order.push_back(u);
+                    seen[u] = true;
+                }
+            }
+        }
+    }
+
+    // u can be mapped to w with respect to the vertices mapped so far
+    bool consistent(int u, int w)
+    {
+        if(mult[u * n + u] != mult[w * n + w])
+        {
+            return false;
+        }
+        for(int x = 0; x < n; ++x)
+        {
+            if(map[x] != -1 && mult[u * n + x] != mult[w * n + map[x]])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool extend(int pos)
+    {
+        if(pos == n)
+        {
+            return true;
+        }
+        if(--nodes < 0)
+        {
+            return false;
+        }
+        int u = order[pos];
+        for(int w = 0; w < n; ++w)
+        {
+            if(used[w] || color[w] != color[u] || !consistent(u, w))
+            {
+                continue;
+            }
+            map[u] = w;
+            used[w] = true;
+            if(extend(pos + 1))
+            {
+                return true;
+            }
+            map[u] = -1;
+            used[w] = false;
+            if(nodes < 0)
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    std::vector<int> edgePermutation() const
+    {
+        std::vector<int> p(lg.size());
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            int u = map[lg.end(e, 0)], v = map[lg.end(e, 1)];
+            p[e] = pair_edges[std::min(u, v) * n + std::max(u, v)][pair_pos[e]];
+        }
+        return p;
+    }
+};
+}  // namespace internal
+}  // namespace ba_graph
+#endif
@@ -0,0 +1,158 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_BLOCKS_HPP
+#define BA_GRAPH_INVARIANTS_ECD_BLOCKS_HPP
+
+#include "ecd_line_graph.hpp"
+#include "ecd_prefilter.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+// size reported for a graph whose search ran out of its budget
+constexpr int ecd_timeout = -2;
+
+namespace internal
+{
+// blocks (maximal 2-connected subgraphs) of g, each with its vertices renumbered to 0..k-1. Every edge lies in
+// exactly one block, isolated vertices are left out
+inline std::vector<EdgeList> ecd_blocks(const EdgeList& g)
+{
+    int n = g.order();
+    std::vector<std::vector<std::pair<int, int>>> adj(n);  // neighbour and edge
+    for(int e = 0; e < g.size(); ++e)
+    {
+        auto [u, v] = g.edges[e];
+        adj[u].emplace_back(v, e);
+        if(u != v)
+        {
+            adj[v].emplace_back(u, e);
+        }
+    }
+
+    std::vector<EdgeList> blocks;
+    std::vector<int> disc(n, -1), low(n, 0), next(n, 0), parent_edge(n, -1);
+    std::vector<int> edge_stack;
+    std::vector<bool> stacked(g.size(), false);
+    std::vector<int> local(n, -1);
+    int time = 0;
+
+    // the edges on the stack above (and including) the edge e form a block
+    auto pop_block = [&](int e) {
+        EdgeList block;
+        std::vector<int> touched;
+        while(true)
+        {
+            int f = edge_stack.back();
+            edge_stack.pop_back();
+            for(int x : {g.edges[f].first, g.edges[f].second})
+            {
+                if(local[x] == -1)
+                {
+                    local[x] = block.n++;
+                    touched.push_back(x);
+                }
+            }
+            block.edges.emplace_back(local[g.edges[f].first], local[g.edges[f].second]);
+            if(f == e)
+            {
+                break;
+            }
+        }
+        for(int x : touched)
+        {
+            local[x] = -1;
+        }
+        blocks.push_back(std::move(block));
+    };
+
+    for(int root = 0; root < n; ++root)
+    {
+        if(disc[root] != -1)
+        {
+            continue;
+        }
+        disc[root] = low[root] = time++;
+        std::vector<int> dfs = {root};
+        while(!dfs.empty())
+        {
+            int v = dfs.back();
+            if(next[v] < (int)adj[v].size())
+            {
+                auto [u, e] = adj[v][next[v]++];
+                if(e == parent_edge[v] || stacked[e])
+                {
+                    continue;
+                }
+                stacked[e] = true;
+                edge_stack.push_back(e);
+                if(disc[u] == -1)
+                {
+                    disc[u] = low[u] = time++;
+                    parent_edge[u] = e;
+                    dfs.push_back(u);
+                }
+                else
+                {
+                    low[v] = std::min(low[v], disc[u]);
+                }
+                continue;
+            }
+
+            dfs.pop_back();
+            if(dfs.empty())
+            {
+                break;
+            }
+            int p = dfs.back();
+            low[p] = std::min(low[p], low[v]);
+            if(low[v] >= disc[p])
+            {
+                pop_block(parent_edge[v]);
+            }
+        }
+    }
+    return blocks;
+}
+
+// minimal ecd size of g from the sizes of its blocks found by solve, -1 if some block has no ecd and ecd_timeout
+// if the search of some block ran out of its budget (the first of them decides). Each cycle lies
+// in a single block and blocks share at most one vertex along the block tree, so the colors of every block can be
+// permuted to avoid the cycles already colored at its attaching vertex. The result is thus the maximum over the
+// blocks and over half the degrees. Blocks are solved from the smallest, so a block without ecd is found early
+template <typename Solve>
+inline int ecd_size_by_blocks(const EdgeList& g, Solve solve)
+{
+    if(ecd_prefilter(g) != EcdFilter::none)
+    {
+        return -1;
+    }
+    std::vector<EdgeList> blocks = ecd_blocks(g);
+    if(blocks.size() <= 1)
+    {
+        return solve(g);
+    }
+    std::sort(blocks.begin(), blocks.end(), [](const EdgeList& a, const EdgeList& b) { return a.size() < b.size(); });
+
+    std::vector<int> degree(g.order(), 0);
+    for(auto [u, v] : g.edges)
+    {
+        degree[u]++;
+        degree[v]++;
+    }
+    int size = *std::max_element(degree.begin(), degree.end()) / 2;
+    for(auto& block : blocks)
+    {
+        int block_size = solve(block);
+        if(block_size < 0)
+        {
+            return block_size;
+        }
+        size = std::max(size, block_size);
+    }
+    return size;
+}
+}  // namespace internal
+}  // namespace ba_graph
+#endif
@@ -0,0 +1,248 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_BOUNDS_HPP
+#define BA_GRAPH_INVARIANTS_ECD_BOUNDS_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+struct EcdBounds
+{
+    int lower;  // every ecd has at least this size
+    int upper;  // if there is an ecd, there is one of size at most upper
+    bool witnessed;  // the heuristic found an ecd of size upper
+    std::vector<int> coloring;  // the ecd found by the heuristic, colors as in internal::Ecd (color class c has colors 2*c, 2*c+1)
+};
+
+namespace internal
+{
+// greedy even cycle decomposition: take the first uncovered edge uv and close it into an even cycle by an odd path
+// from v to u found by a dfs over the uncovered edges. Cycles are then colored greedily so that cycles sharing a
+// vertex get different colors. The dfs may get stuck, so it only gives up after a few randomized attempts.
+class EcdGreedy
+{
+  public:
+    EcdGreedy(const EcdLineGraph& lg, int attempts = 4) : lg(lg)
+    {
+        int m = lg.size();
+        incident.resize(lg.order());
+        for(int e = 0; e < m; ++e)
+        {
+            incident[lg.end(e, 0)].push_back(e);
+            if(lg.end(e, 1) != lg.end(e, 0))
+            {
+                incident[lg.end(e, 1)].push_back(e);
+            }
+        }
+
+        std::mt19937 rng(m);
+        for(int a = 0; a < attempts; ++a)
+        {
+            if(a > 0)
+            {
+                for(auto& inc : incident)
+                {
+                    std::shuffle(inc.begin(), inc.end(), rng);
+                }
+            }
+
+            std::vector<std::vector<int>> cycles;
+            if(!decompose(cycles))
+            {
+                continue;
+            }
+            std::vector<int> col = colorCycles(cycles);
+            int size = 0;
+            for(int c : col)
+            {
+                size = std::max(size, c / 2 + 1);
+            }
+            if(!found || size < min_size)
+            {
+                found = true;
+                min_size = size;
+                min_coloring = std::move(col);
+            }
+        }
+    }
+
+    bool hasEcd() const
+    {
+        return found;
+    }
+
+    int getSize() const
+    {
+        return found ? min_size : -1;
+    }
+
+    const std::vector<int>& getColoring() const
+    {
+        return min_coloring;
+    }
+
+  private:
+    const EcdLineGraph& lg;
+    std::vector<std::vector<int>> incident;
+    bool found = false;
+    int min_size = 0;
+    std::vector<int> min_coloring;
+
+    std::vector<bool> covered;
+    std::vector<bool> visited;
+    std::vector<int> path;
+    long long steps = 0;
+
+    bool decompose(std::vector<std::vector<int>>& cycles)
+    {
+        int m = lg.size();
+        covered.assign(m, false);
+        visited.assign(lg.order(), false);
+        steps = 1000 + 100LL * m;
+
+        for(int e = 0; e < m; ++e)
+        {
+            if(covered[e])
+            {
+                continue;
+            }
+            int u = lg.end(e, 0);
+            int v = lg.end(e, 1);
+            if(u == v)
+            {
+                return false;
+            }
+
+            covered[e] = true;
+            path.assign(1, e);
+            visited[v] = true;
+            bool closed = findPath(v, u);
+            visited[v] = false;
+            if(!closed)
+            {
+                return false;
+            }
+            for(int f : path)
+            {
+                covered[f] = true;
+            }
+            cycles.push_back(path);
+        }
+        return true;
+    }
+
+    // odd path from x to target over uncovered edges, appended to path
+    bool findPath(int x, int target)
+    {
+        if(--steps < 0)
+        {
+            return false;
+        }
+        for(int f : incident[x])
+        {
+            if(covered[f])
+            {
+                continue;
+            }
+            int y = lg.end(f, 0) == x ? lg.end(f, 1) : lg.end(f, 0);
+            // closing the cycle by f gives path.size() + 1 edges
+            if(y == target)
+            {
+                if(path.size() & 1)
+                {
+                    path.push_back(f);
+                    return true;
+                }
+                continue;
+            }
+            if(visited[y])
+            {
+                continue;
+            }
+
+            visited[y] = true;
+            covered[f] = true;
+            path.push_back(f);
+            if(findPath(y, target))
+            {
+                visited[y] = false;
+                return true;
+            }
+            path.pop_back();
+            covered[f] = false;
+            visited[y] = false;
+        }
+        return false;
+    }
+
+    // longer cycles first, each gets the smallest color class not used by a cycle sharing a vertex with it
+    std::vector<int> colorCycles(std::vector<std::vector<int>>& cycles)
+    {
+        std::stable_sort(cycles.begin(), cycles.end(), [](const auto& a, const auto& b) { return a.size() > b.size(); });
+
+        std::vector<std::vector<int>> vert_classes(lg.order());
+        std::vector<int> col(lg.size(), -1);
+        for(auto& cycle : cycles)
+        {
+            std::vector<int> used;
+            for(int e : cycle)
+            {
+                for(int side = 0; side < 2; ++side)
+                {
+                    auto& cl = vert_classes[lg.end(e, side)];
+                    used.insert(used.end(), cl.begin(), cl.end());
+                }
+            }
+            std::sort(used.begin(), used.end());
+            int c = 0;
+            for(int x : used)
+            {
+                if(x == c)
+                {
+                    c++;
+                }
+            }
+
+            for(size_t i = 0; i < cycle.size(); ++i)
+            {
+                col[cycle[i]] = 2 * c + (int)(i & 1);
+                vert_classes[lg.end(cycle[i], 0)].push_back(c);
+                vert_classes[lg.end(cycle[i], 1)].push_back(c);
+            }
+        }
+        return col;
+    }
+};
+
+inline EcdBounds ecd_bounds(const EcdLineGraph& lg)
+{
+    EcdBounds bounds;
+    // every color class is 2-regular, so a vertex of degree d lies in d/2 of them
+    bounds.lower = std::max(lg.size() > 0 ? 1 : 0, lg.maxDegree() / 2);
+    // each color class has a cycle of length at least 4 (2 if there are parallel edges)
+    bounds.upper = lg.size() / (lg.hasParallelEdge() ? 2 : 4);
+
+    EcdGreedy greedy(lg);
+    bounds.witnessed = greedy.hasEcd();
+    if(bounds.witnessed)
+    {
+        bounds.upper = greedy.getSize();
+        bounds.coloring = greedy.getColoring();
+    }
+    return bounds;
+}
+}  // namespace internal
+
+// cheap bounds on the ecd size, lower from the degrees and upper from a greedy ecd (if it finds one)
+inline EcdBounds ecd_bounds(const Graph& g)
+{
+    internal::EcdLineGraph lg(g);
+
+    return internal::ecd_bounds(lg);
+}
+}  // namespace ba_graph
+#endif
@@ -0,0 +1,203 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_BUDGET_HPP
+#define BA_GRAPH_INVARIANTS_ECD_BUDGET_HPP
+
+#include "ecd.hpp"
+#include "ecd_sat.hpp"
+
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ba_graph
+{
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+// limits of the search of one graph by one engine, 0 is no limit
+struct EcdBudget
+{
+    double seconds = 0;
+    long long nodes = 0;  // nodes of the backtracking or conflicts of the sat, for every block of the graph
+
+    bool limited() const
+    {
+        return seconds > 0 || nodes > 0;
+    }
+};
+
+enum class EcdEngine
+{
+    backtracking,
+    sat,  // the incremental one, it can be interrupted
+};
+
+// one engine of the fallback chain with its settings
+struct EcdAttempt
+{
+    EcdEngine engine = EcdEngine::backtracking;
+    EcdOrdering ordering;  // of the backtracking
+    EcdEncoding encoding;  // of the sat
+};
+
+namespace internal
+{
+// one timer thread for all the searches of the thread that owns it, started with the first one. arm() sets the
+// deadline of the next search and disarm() drops it, so a graph solved in microseconds costs no thread
+class EcdWatchdog
+{
+  public:
+    EcdWatchdog() = default;
+    EcdWatchdog(const EcdWatchdog&) = delete;
+    EcdWatchdog& operator=(const EcdWatchdog&) = delete;
+
+    ~EcdWatchdog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_one();
+        if(timer.joinable())
+        {
+            timer.join();
+        }
+    }
+
+    // cancel is cancelled once the seconds pass, unless disarm() is called before
+    void arm(double seconds, EcdCancel& cancel)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!timer.joinable())
+        {
+            timer = std::thread([this]() { watch(); });
+        }
+        target = &cancel;
+        deadline = std::chrono::steady_clock::now() +
+                   std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        wake.notify_one();
+    }
+
+    // after it returns, the cancel of the last arm() is not touched anymore
+    void disarm()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        target = nullptr;
+    }
+
+  private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread timer;
+    EcdCancel* target = nullptr;
+    std::chrono::steady_clock::time_point deadline;
+    bool quit = false;
+
+    void watch()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(!quit)
+        {
+            if(!target)
+            {
+                wake.wait(lock);
+            }
+            else if(std::chrono::steady_clock::now() >= deadline)
+            {
+                target->cancel();
+                target = nullptr;
+            }
+            else
+            {
+                wake.wait_until(lock, deadline);
+            }
+        }
+    }
+};
+
+// cancels the search once the seconds pass, unless it is destroyed before. The searches only watch the flag of
+// cancel, so the clock is looked at by the watchdog of this thread
+class EcdDeadline
+{
+  public:
+    EcdDeadline(double seconds, EcdCancel& cancel)
+    {
+        if(seconds > 0)
+        {
+            watchdog().arm(seconds, cancel);
+            armed = true;
+        }
+    }
+
+    EcdDeadline(const EcdDeadline&) = delete;
+    EcdDeadline& operator=(const EcdDeadline&) = delete;
+
+    ~EcdDeadline()
+    {
+        if(armed)
+        {
+            watchdog().disarm();
+        }
+    }
+
+  private:
+    bool armed = false;
+
+    static EcdWatchdog& watchdog()
+    {
+        thread_local EcdWatchdog watchdog;
+        return watchdog;
+    }
+};
+}  // namespace internal
+
+// minimal size of the ecd by the engine of attempt, -1 if there is none and ecd_timeout if it runs out of the budget
+inline int ecd_size_within(const EdgeList& g, const EcdAttempt& attempt, const EcdBudget& budget)
+{
+    internal::EcdCancel cancel;
+    internal::EcdDeadline deadline(budget.seconds, cancel);
+    long long nodes = budget.nodes > 0 ? budget.nodes : LLONG_MAX;
+    return internal::ecd_size_by_blocks(g, [&](const EdgeList& block) {
+        if(attempt.engine == EcdEngine::sat)
+        {
+            return internal::ecd_size_sat_incremental(internal::EcdLineGraph(block),
+                                                      attempt.encoding.symmetry != SymmetryBreaking::none, attempt.encoding,
+                                                      nullptr, &cancel, nodes);
+        }
+        internal::Ecd ecd(block, INT_MAX, false, cancel.flag(), attempt.ordering, nodes);
+        return ecd.interrupted() ? ecd_timeout : ecd.getSize();
+    });
+}
+
+// the attempts one after another, each with the whole budget, until one of them completes. ecd_timeout if all of
+// them run out, *answered is then -1 and otherwise the index of the attempt which completed
+inline int ecd_size_fallback(const EdgeList& g, const std::vector<EcdAttempt>& chain, const EcdBudget& budget,
+                             int* answered = nullptr)
+{
+    for(int i = 0; i < (int)chain.size(); ++i)
+    {
+        int size = ecd_size_within(g, chain[i], budget);
+        if(size != ecd_timeout)
+        {
+            if(answered)
+            {
+                *answered = i;
+            }
+            return size;
+        }
+    }
+    if(answered)
+    {
+        *answered = -1;
+    }
+    return ecd_timeout;
+}
+
+inline int ecd_size_fallback(const Graph& g, const std::vector<EcdAttempt>& chain, const EcdBudget& budget,
+                             int* answered = nullptr)
+{
+    return ecd_size_fallback(edge_list(g), chain, budget, answered);
+}
+#endif
+}  // namespace ba_graph
+#endif
@@ -0,0 +1,377 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_CACHE_HPP
+#define BA_GRAPH_INVARIANTS_ECD_CACHE_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+// key of a graph up to isomorphism, two independent hashes of its canonical form
+struct EcdCacheKey
+{
+    uint64_t hash = 0;
+    uint32_t check = 0;
+};
+
+namespace internal
+{
+// canonical form of a multigraph by individualization and refinement: the coloring is refined until it is
+// equitable, then every vertex of the first non-trivial cell is individualized in turn. Each discrete coloring
+// relabels the graph and the lexicographically smallest sorted edge list is the canonical form. There is no
+// automorphism pruning, so the number of leaves is limited
+class EcdCanonicalForm
+{
+  public:
+    EcdCanonicalForm(const EdgeList& g, long long leaf_limit = 10000) : n(g.n), leaves(leaf_limit)
+    {
+        std::map<std::pair<int, int>, int> mult;
+        for(auto [u, v] : g.edges)
+        {
+            mult[{std::min(u, v), std::max(u, v)}]++;
+        }
+        adj.resize(n);
+        loops.assign(n, 0);
+        for(auto& [e, k] : mult)
+        {
+            if(e.first == e.second)
+            {
+                loops[e.first] = k;
+                continue;
+            }
+            adj[e.first].emplace_back(e.second, k);
+            adj[e.second].emplace_back(e.first, k);
+        }
+        edges = g.edges;
+
+        std::vector<int> color(n);
+        for(int v = 0; v < n; ++v)
+        {
+            color[v] = (int)adj[v].size() * (g.size() + 1) + loops[v];
+        }
+        refine(color);
+        search(color);
+    }
+
+    // false if the leaf limit was reached, the form is not canonical then
+    bool found() const
+    {
+        return leaves >= 0;
+    }
+
+    // sorted edges of the graph relabelled by the canonical labelling
+    const std::vector<std::pair<int, int>>& form() const
+    {
+        return best;
+    }
+
+    EcdCacheKey key() const
+    {
+        // FNV-1a for the hash, a multiplicative mix with a different seed for the check
+        uint64_t h = 14695981039346656037ull;
+        uint64_t c = 0x9e3779b97f4a7c15ull;
+        auto add = [&](uint64_t x) {
+            for(int i = 0; i < 4; ++i)
+            {
+                h = (h ^ ((x >> (16 * i)) & 0xffff)) * 1099511628211ull;
+            }
+            c = (c ^ x) * 0xff51afd7ed558ccdull;
+            c ^= c >> 33;
+        };
+        add((uint64_t)n);
+        for(auto [u, v] : best)
+        {
+            add(((uint64_t)u << 32) | (uint32_t)v);
+        }
+        return {h, (uint32_t)(c ^ (c >> 32))};
+    }
+
+  private:
+    int n;
+    long long leaves;
+    std::vector<std::vector<std::pair<int, int>>> adj;  // neighbour and the number of edges to it
+    std::vector<int> loops;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<std::pair<int, int>> best;
+    bool has_best = false;
+
+    // colors of the equitable refinement numbered 0..k-1 by their signatures, so the result does not depend on the labels
+    void refine(std::vector<int>& color) const
+    {
+        int classes = -1;
+        while(true)
+        {
+            std::vector<std::vector<int>> sig(n);
+            for(int v = 0; v < n; ++v)
+            {
+                sig[v].push_back(color[v]);
+                for(auto [u, k] : adj[v])
+                {
+                    sig[v].push_back(color[u] * (int)(edges.size() + 1) + k);
+                }
+                std::sort(sig[v].begin() + 1, sig[v].end());
+            }
+            std::map<std::vector<int>, int> ids;
+            for(int v = 0; v < n; ++v)
+            {
+                ids.emplace(sig[v], 0);
+            }
+            int id = 0;
+            for(auto& [s, i] : ids)
+            {
+                i = id++;
+            }
+            for(int v = 0; v < n; ++v)
+            {
+                color[v] = ids[sig[v]];
+            }
+            if((int)ids.size() == classes)
+            {
+                return;
+            }
+            classes = (int)ids.size();
+        }
+    }
+
+    void search(const std::vector<int>& color)
+    {
+        if(leaves < 0)
+        {
+            return;
+        }
+        // the smallest color shared by several vertices
+        std::vector<int> count(n, 0);
+        for(int v = 0; v < n; ++v)
+        {
+            count[color[v]]++;
+        }
+        int cell = (int)(std::find_if(count.begin(), count.end(), [](int k) { return k > 1; }) - count.begin());
+        if(cell == n)
+        {
+            leaf(color);
+            return;
+        }
+        for(int v = 0; v < n; ++v)
+        {
+            if(color[v] != cell)
+            {
+                continue;
+            }
+            std::vector<int> next(n);
+            for(int u = 0; u < n; ++u)
+            {
+                next[u] = 2 * color[u] + (color[u] == cell && u != v);
+            }
+            refine(next);
+            search(next);
+            if(leaves < 0)
+            {
+                return;
+            }
+        }
+    }
+
+    void leaf(const std::vector<int>& color)
+    {
+        if(--leaves < 0)
+        {
+            return;
+        }
+        std::vector<std::pair<int, int>> relabelled;
+        relabelled.reserve(edges.size());
+        for(auto [u, v] : edges)
+        {
+            relabelled.emplace_back(std::min(color[u], color[v]), std::max(color[u], color[v]));
+        }
+        std::sort(relabelled.begin(), relabelled.end());
+        if(!has_best || relabelled < best)
+        {
+            best = std::move(relabelled);
+            has_best = true;
+        }
+    }
+};
+}  // namespace internal
+
+// key of g up to isomorphism, false if the canonical form was too expensive
+inline bool ecd_cache_key(const EdgeList& g, EcdCacheKey& key)
+{
+    internal::EcdCanonicalForm form(g);
+    if(!form.found())
+    {
+        return false;
+    }
+    key = form.key();
+    return true;
+}
+
+// ecd sizes stored on disk by the keys of the graphs. The file is the header followed by fixed size records and is
+// only ever appended to, every record with a single write, so other processes can read and append to it at the
+// same time. Opening takes an exclusive lock on the file and appending a shared one, so the header is written
+// once and the records are read when no append is halfway through. Records already in the file are read through
+// a memory map when it is opened.
+class EcdCache
+{
+  public:
+    explicit EcdCache(const std::string& file)
+    {
+        fd = open(file.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if(fd < 0)
+        {
+            throw std::runtime_error("cannot open cache " + file);
+        }
+        try
+        {
+            FileLock lock(fd, LOCK_EX);
+            load(file);
+        }
+        catch(...)
+        {
+            close(fd);
+            throw;
+        }
+    }
+
+    EcdCache(const EcdCache&) = delete;
+    EcdCache& operator=(const EcdCache&) = delete;
+
+    ~EcdCache()
+    {
+        close(fd);
+    }
+
+    bool lookup(const EcdCacheKey& key, int& size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = sizes.find(key.hash);
+        if(it == sizes.end() || it->second.first != key.check)
+        {
+            return false;
+        }
+        size = it->second.second;
+        return true;
+    }
+
+    void insert(const EcdCacheKey& key, int size)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!sizes.emplace(key.hash, std::make_pair(key.check, size)).second)
+        {
+            return;
+        }
+        Record r{key.hash, key.check, size};
+        FileLock file_lock(fd, LOCK_SH);
+        if(write(fd, &r, sizeof(r)) != (ssize_t)sizeof(r))
+        {
+            throw std::runtime_error("cannot write cache");
+        }
+    }
+
+  private:
+    struct Record
+    {
+        uint64_t hash;
+        uint32_t check;
+        int32_t size;
+    };
+    static_assert(sizeof(Record) == 16);
+    static constexpr char magic[8] = {'E', 'C', 'D', 'C', 'A', 'C', 'H', '1'};
+
+    // flock held for the lifetime of the object
+    class FileLock
+    {
+      public:
+        FileLock(int fd, int operation) : fd(fd)
+        {
+            while(flock(fd, operation) != 0)
+            {
+                if(errno != EINTR)
+                {
+                    throw std::runtime_error("cannot lock cache");
+                }
+            }
+        }
+
+        FileLock(const FileLock&) = delete;
+        FileLock& operator=(const FileLock&) = delete;
+
+        ~FileLock()
+        {
+            flock(fd, LOCK_UN);
+        }
+
+      private:
+        int fd;
+    };
+
+    int fd;
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::pair<uint32_t, int>> sizes;
+
+    // with the exclusive lock held: the header of a new file, or the records of an existing one
+    void load(const std::string& file)
+    {
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            throw std::runtime_error("cannot stat cache " + file);
+        }
+        size_t length = (size_t)st.st_size;
+        if(length == 0)
+        {
+            if(write(fd, magic, sizeof(magic)) != (ssize_t)sizeof(magic))
+            {
+                throw std::runtime_error("cannot write cache " + file);
+            }
+            return;
+        }
+
+        void* p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if(p == MAP_FAILED)
+        {
+            throw std::runtime_error("cannot map cache " + file);
+        }
+        const char* data = static_cast<const char*>(p);
+        // a second header in place of the first record is left by two processes which created the file at once
+        // without the lock, the records after it are shifted
+        bool valid = length >= sizeof(magic) && memcmp(data, magic, sizeof(magic)) == 0 &&
+                     (length < 2 * sizeof(magic) || memcmp(data + sizeof(magic), magic, sizeof(magic)) != 0);
+        size_t records = valid ? (length - sizeof(magic)) / sizeof(Record) : 0;
+        for(size_t i = 0; i < records; ++i)
+        {
+            Record r;
+            memcpy(&r, data + sizeof(magic) + i * sizeof(Record), sizeof(Record));
+            sizes[r.hash] = {r.check, r.size};
+        }
+        munmap(p, length);
+        if(!valid)
+        {
+            throw std::runtime_error("not an ecd cache " + file);
+        }
+        // no append is in progress, so a partial record at the end is left by one which was cut off and would
+        // shift all the records appended after it
+        size_t whole = sizeof(magic) + records * sizeof(Record);
+        if(whole != length && ftruncate(fd, (off_t)whole) != 0)
+        {
+            throw std::runtime_error("cannot truncate cache " + file);
+        }
+    }
+};
+}  // namespace ba_graph
+#endif
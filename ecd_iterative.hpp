@@ -0,0 +1,535 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_ITERATIVE_HPP
+#define BA_GRAPH_INVARIANTS_ECD_ITERATIVE_HPP
+
+#include "ecd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ba_graph
+{
+namespace internal
+{
+// write writes the contents to a temporary file which then replaces file, so a crash leaves the old one
+template <typename Write>
+inline void ecd_write_replacing(const std::string& file, Write write)
+{
+    std::string tmp = file + ".tmp";
+    {
+        std::ofstream out(tmp);
+        write(out);
+        if(!out)
+        {
+            throw std::runtime_error("cannot write checkpoint " + tmp);
+        }
+    }
+    if(std::rename(tmp.c_str(), file.c_str()) != 0)
+    {
+        throw std::runtime_error("cannot replace checkpoint " + file);
+    }
+}
+
+// one call of startCycle (col == -1, next is the next color class to try) or of findCycle (vert has the color col,
+// next is the smallest neighbour which was not tried yet, closed if its cycle is complete)
+struct EcdFrame
+{
+    int vert;
+    int col;
+    int cur_size;
+    int next;
+    bool closed;
+};
+
+// the search of Ecd with an explicit stack of frames instead of the recursion, so it can be stopped after some
+// nodes, inspected and continued, or saved to a file and resumed from it in another process. It explores the
+// same tree in the same order as startCycle and findCycle, only without the splitting and the restarts
+class EcdIterative : public Ecd
+{
+  public:
+    EcdIterative(const EdgeList& g, const EcdOrdering& ordering = {})
+        : Ecd(EcdLineGraph(g), own_best, nullptr, nullptr, ordering)
+    {
+        start();
+    }
+
+    // g is only needed by getEcd
+    EcdIterative(const Graph& g, const EcdOrdering& ordering = {}) : Ecd(EcdLineGraph(g), own_best, nullptr, &g, ordering)
+    {
+        start();
+    }
+
+    // explore at most nodes more nodes, returns true once the search is complete
+    bool step(long long nodes = LLONG_MAX)
+    {
+        auto start_time = std::chrono::steady_clock::now();
+        while(!stack.empty() && nodes > 0)
+        {
+            int entered = advance();
+            nodes -= entered;
+            explored += entered;
+        }
+        if(stats_target)
+        {
+            counters.search_time += ecd_seconds_since(start_time);
+        }
+        return finished();
+    }
+
+    bool finished() const
+    {
+        return stack.empty();
+    }
+
+    const std::vector<EcdFrame>& frames() const
+    {
+        return stack;
+    }
+
+    // nodes entered by step() so far
+    long long nodesExplored() const
+    {
+        return explored;
+    }
+
+    // the graph, the order, the incumbent and the stack
+    void save(std::ostream& out) const
+    {
+        out << magic << "\n" << lg.order() << " " << lg.size();
+        for(int e = 0; e < lg.size(); ++e)
+        {
+            out << " " << lg.end(e, 0) << " " << lg.end(e, 1);
+        }
+        out << "\n" << (int)ordering.order << " " << ordering.seed << "\n";
+        out << getSize();
+        if(best.found())
+        {
+            for(int c : best.coloring())
+            {
+                out << " " << c;
+            }
+        }
+        out << "\n" << stack.size() << "\n";
+        for(auto& f : stack)
+        {
+            out << f.vert << " " << f.col << " " << f.cur_size << " " << f.next << " " << f.closed << "\n";
+        }
+    }
+
+    // save() to a temporary file which then replaces file
+    void save(const std::string& file) const
+    {
+        ecd_write_replacing(file, [&](std::ostream& out) { save(out); });
+    }
+
+    bool load(const std::string& file)
+    {
+        std::ifstream in(file);
+        return load(in);
+    }
+
+    // continue the search saved by save(), false (and the state is kept) if there is none or it is of another graph
+    bool load(std::istream& in)
+    {
+        std::string header;
+        int n, m;
+        if(!(in >> header >> n >> m) || header != magic || n != lg.order() || m != lg.size())
+        {
+            return false;
+        }
+        for(int e = 0; e < m; ++e)
+        {
+            int u, v;
+            if(!(in >> u >> v) || u != lg.end(e, 0) || v != lg.end(e, 1))
+            {
+                return false;
+            }
+        }
+        int order;
+        uint32_t seed;
+        int size;
+        if(!(in >> order >> seed >> size) || order != (int)ordering.order || seed != ordering.seed)
+        {
+            return false;
+        }
+        std::vector<int> incumbent(size == -1 ? 0 : m);
+        for(int& c : incumbent)
+        {
+            in >> c;
+        }
+        size_t frame_count;
+        in >> frame_count;
+        std::vector<EcdFrame> frames(in ? frame_count : 0);
+        for(auto& f : frames)
+        {
+            in >> f.vert >> f.col >> f.cur_size >> f.next >> f.closed;
+        }
+        if(!in || !feasible)
+        {
+            return false;
+        }
+        for(auto& f : frames)
+        {
+            if(f.vert < 0 || f.vert >= m || f.col >= colors)
+            {
+                return false;
+            }
+        }
+
+        clear();
+        if(size != -1)
+        {
+            best.offer(size, incumbent);
+        }
+        for(auto& f : frames)
+        {
+            if(f.col != -1)
+            {
+                colorVert(f.vert, f.col);
+                depth += f.closed;
+            }
+        }
+        stack = std::move(frames);
+        return true;
+    }
+
+  private:
+    static constexpr const char* magic = "ECDCHECKPOINT1";
+    std::vector<EcdFrame> stack;
+    long long explored = 0;
+
+    void start()
+    {
+        if(feasible && applyBounds())
+        {
+            enterStart(0);
+        }
+    }
+
+    // unwind the whole stack, the coloring is then empty
+    void clear()
+    {
+        while(!stack.empty())
+        {
+            pop();
+        }
+    }
+
+    void pop()
+    {
+        EcdFrame f = stack.back();
+        stack.pop_back();
+        if(f.col != -1)
+        {
+            uncolorVert(f.vert);
+            depth -= f.closed;
+        }
+    }
+
+    // the beginning of startCycle, a frame is pushed if there are branches to try
+    void enterStart(int cur_size)
+    {
+        if(stopped())
+        {
+            count(counters.prune_done);
+            return;
+        }
+        count(counters.nodes);
+        int start_vert = nextEdge();
+        if(start_vert == -1)
+        {
+            best.offer(cur_size, coloring);
+            return;
+        }
+        if(!forwardCheck(start_vert, 0, cur_size, true))
+        {
+            count(counters.prune_forward);
+            return;
+        }
+        stack.push_back({start_vert, -1, cur_size, 0, false});
+    }
+
+    // the beginning of findCycle for the just colored vert, false if no frame was pushed and vert has to be uncolored
+    bool enterFind(int vert, int col, int cur_size)
+    {
+        if(stopped())
+        {
+            count(counters.prune_done);
+            return false;
+        }
+        count(counters.nodes);
+        int u = lg.end(vert, 0);
+        int v = lg.end(vert, 1);
+        int cnt_col = atVertex(u, col) + atVertex(v, col) - 2;
+        int cnt_oth_col = atVertex(u, col ^ 1) + atVertex(v, col ^ 1);
+        if(cnt_col > 0 || cnt_oth_col > 2)
+        {
+            count(counters.prune_conflict);
+            return false;
+        }
+        if(!forwardCheck(vert, col, cur_size))
+        {
+            count(counters.prune_forward);
+            return false;
+        }
+        bool closed = cnt_oth_col == 2;
+        stack.push_back({vert, col, cur_size, 0, closed});
+        if(closed)
+        {
+            depth++;
+            countDepth();
+            enterStart(cur_size);
+        }
+        return true;
+    }
+
+    // the smallest uncolored neighbour of vert numbered at least from, -1 if there is none
+    int nextNeighbour(int vert, int from) const
+    {
+        const Word* star1 = lg.star(lg.end(vert, 0));
+        const Word* star2 = lg.star(lg.end(vert, 1));
+        for(int w = from / EcdLineGraph::word_bits; w < words; ++w)
+        {
+            Word cand = (star1[w] | star2[w]) & uncolored[w];
+            if(w == from / EcdLineGraph::word_bits)
+            {
+                cand &= ~Word(0) << (from % EcdLineGraph::word_bits);
+            }
+            if(cand)
+            {
+                return w * EcdLineGraph::word_bits + std::countr_zero(cand);
+            }
+        }
+        return -1;
+    }
+
+    // take the next branch of the top frame or pop it if there is none, returns the number of nodes entered
+    int advance()
+    {
+        EcdFrame& f = stack.back();
+        int vert = -1, col = 0, size = 0;
+        if(f.col == -1)
+        {
+            if(f.next < f.cur_size)
+            {
+                vert = f.vert;
+                col = 2 * f.next++;
+                size = f.cur_size;
+            }
+            else if(f.next == f.cur_size)
+            {
+                f.next++;
+                if(f.cur_size + 1 >= best.size())
+                {
+                    count(counters.prune_bound);
+                }
+                else
+                {
+                    vert = f.vert;
+                    col = 2 * f.cur_size;
+                    size = f.cur_size + 1;
+                }
+            }
+        }
+        else if(!f.closed)
+        {
+            vert = nextNeighbour(f.vert, f.next);
+            if(vert != -1)
+            {
+                f.next = vert + 1;
+                col = f.col ^ 1;
+                size = f.cur_size;
+            }
+        }
+
+        if(vert == -1)
+        {
+            pop();
+            return 0;
+        }
+        colorVert(vert, col);
+        if(!enterFind(vert, col, size))
+        {
+            uncolorVert(vert);
+        }
+        return 1;
+    }
+};
+
+// contents of the checkpoint file of ecd_size_checkpointed: the sizes of the blocks already finished and the saved
+// search of at most one block. That block owns the file until it is finished, no other block overwrites its state
+struct EcdCheckpointState
+{
+    std::vector<std::pair<EdgeList, int>> finished;
+    std::string active;  // EcdIterative::save of the block being searched, empty if there is none
+
+    // a missing file is an empty state
+    void read(const std::string& file)
+    {
+        std::ifstream in(file);
+        if(!in)
+        {
+            return;
+        }
+        std::string header;
+        size_t count;
+        if(!(in >> header >> count) || header != magic)
+        {
+            throw std::runtime_error("not a checkpoint file " + file);
+        }
+        finished.resize(count);
+        for(auto& [block, size] : finished)
+        {
+            int m;
+            in >> block.n >> m;
+            block.edges.resize(std::max(m, 0));
+            for(auto& [u, v] : block.edges)
+            {
+                in >> u >> v;
+            }
+            in >> size;
+        }
+        size_t length;
+        in >> length;
+        in.get();
+        active.resize(length);
+        in.read(active.data(), (std::streamsize)length);
+        if(!in)
+        {
+            throw std::runtime_error("corrupted checkpoint file " + file);
+        }
+    }
+
+    void write(const std::string& file) const
+    {
+        ecd_write_replacing(file, [&](std::ostream& out) {
+            out << magic << "\n" << finished.size() << "\n";
+            for(auto& [block, size] : finished)
+            {
+                out << block.n << " " << block.size();
+                for(auto [u, v] : block.edges)
+                {
+                    out << " " << u << " " << v;
+                }
+                out << " " << size << "\n";
+            }
+            out << active.size() << "\n" << active;
+        });
+    }
+
+    // size of the finished block, nullptr if it is not there
+    const int* find(const EdgeList& block) const
+    {
+        for(auto& [done, size] : finished)
+        {
+            if(done.n == block.n && done.edges == block.edges)
+            {
+                return &size;
+            }
+        }
+        return nullptr;
+    }
+
+    void forget(const EdgeList& block)
+    {
+        std::erase_if(finished, [&](const std::pair<EdgeList, int>& done) {
+            return done.first.n == block.n && done.first.edges == block.edges;
+        });
+    }
+
+  private:
+    static constexpr const char* magic = "ECDBLOCKS1";
+};
+}  // namespace internal
+
+// where and how often the iterative search saves its state
+struct EcdCheckpoint
+{
+    std::string file;
+    double interval = 60;  // seconds
+    long long nodes = 0;   // the search saves its state and gives up after so many nodes, 0 is no limit
+};
+
+// minimal size of the ecd by the iterative search, -1 if there is none and ecd_timeout if it runs out of nodes. The
+// blocks of g are searched one after another, the sizes of the finished ones are kept in the checkpoint file and
+// the state of the one being searched is saved there every interval seconds. A run of g again skips the finished
+// blocks and resumes the saved one. The blocks of g are dropped from the file once g is done. While the file holds
+// the search of a block of another graph, the blocks of g are searched without saving it
+inline int ecd_size_checkpointed(const EdgeList& g, const EcdCheckpoint& checkpoint, const EcdOrdering& ordering = {})
+{
+    internal::EcdCheckpointState state;
+    state.read(checkpoint.file);
+    long long nodes_left = checkpoint.nodes > 0 ? checkpoint.nodes : LLONG_MAX;
+    std::vector<EdgeList> blocks;  // looked up or searched
+    bool saved = false;            // the file has some of them
+    int size = internal::ecd_size_by_blocks(g, [&](const EdgeList& block) {
+        blocks.push_back(block);
+        if(const int* done = state.find(block))
+        {
+            saved = true;
+            return *done;
+        }
+        internal::EcdIterative ecd(block, ordering);
+        std::istringstream active(state.active);
+        bool owner = state.active.empty() || ecd.load(active);
+        saved |= owner && !state.active.empty();
+        auto save = [&]() {
+            if(owner)
+            {
+                std::ostringstream out;
+                ecd.save(out);
+                state.active = out.str();
+                state.write(checkpoint.file);
+                saved = true;
+            }
+        };
+
+        // nodes between two looks at the clock
+        const long long slice = 1 << 16;
+        auto last = std::chrono::steady_clock::now();
+        while(!ecd.step(std::min(slice, nodes_left - ecd.nodesExplored())))
+        {
+            if(ecd.nodesExplored() >= nodes_left)
+            {
+                save();
+                return ecd_timeout;
+            }
+            if(internal::ecd_seconds_since(last) >= checkpoint.interval)
+            {
+                save();
+                last = std::chrono::steady_clock::now();
+            }
+        }
+        nodes_left -= ecd.nodesExplored();
+        state.finished.emplace_back(block, ecd.getSize());
+        // the file only needs the result once it has some of the state of g, short searches are not written
+        if(owner && saved)
+        {
+            state.active.clear();
+            state.write(checkpoint.file);
+        }
+        return ecd.getSize();
+    });
+    if(size != ecd_timeout && saved)
+    {
+        for(auto& block : blocks)
+        {
+            state.forget(block);
+        }
+        state.write(checkpoint.file);
+    }
+    return size;
+}
+
+inline int ecd_size_checkpointed(const Graph& g, const EcdCheckpoint& checkpoint, const EcdOrdering& ordering = {})
+{
+    return ecd_size_checkpointed(edge_list(g), checkpoint, ordering);
+}
+}  // namespace ba_graph
+#endif
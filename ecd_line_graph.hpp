@@ -0,0 +1,277 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_LINE_GRAPH_HPP
+#define BA_GRAPH_INVARIANTS_ECD_LINE_GRAPH_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+// compact graph for the ecd engines, vertices are 0..n-1 and edges are pairs of them (parallel edges and loops allowed)
+struct EdgeList
+{
+    int n = 0;
+    std::vector<std::pair<int, int>> edges;
+
+    int order() const
+    {
+        return n;
+    }
+
+    int size() const
+    {
+        return (int)edges.size();
+    }
+};
+
+// g with its vertices renumbered to 0..n-1 in the order of the rotations
+inline EdgeList edge_list(const Graph& g)
+{
+    EdgeList list;
+    int max_num = -1;
+    for(auto& r : g)
+    {
+        max_num = std::max(max_num, r.n().to_int());
+    }
+    std::vector<int> vert_index(max_num + 1, -1);
+    for(auto& r : g)
+    {
+        vert_index[r.n().to_int()] = list.n++;
+    }
+    for(auto& r : g)
+    {
+        for(auto& i : r)
+        {
+            if(i.is_primary())
+            {
+                list.edges.emplace_back(vert_index[i.n1().to_int()], vert_index[i.n2().to_int()]);
+            }
+        }
+    }
+    return list;
+}
+
+// line graph of g, the i-th edge of g is the vertex i. Buffers of lg are reused
+inline void line_graph(const EdgeList& g, EdgeList& lg)
+{
+    lg.n = g.size();
+    lg.edges.clear();
+    // incident edges of each vertex, grouped by a counting sort
+    std::vector<int> start(g.n + 1, 0);
+    for(auto& [u, v] : g.edges)
+    {
+        start[u + 1]++;
+        if(u != v)
+        {
+            start[v + 1]++;
+        }
+    }
+    for(int v = 0; v < g.n; ++v)
+    {
+        start[v + 1] += start[v];
+    }
+    std::vector<int> incident(start[g.n]);
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for(int e = 0; e < g.size(); ++e)
+    {
+        auto [u, v] = g.edges[e];
+        incident[pos[u]++] = e;
+        if(u != v)
+        {
+            incident[pos[v]++] = e;
+        }
+    }
+
+    for(int v = 0; v < g.n; ++v)
+    {
+        for(int i = start[v]; i < start[v + 1]; ++i)
+        {
+            for(int j = i + 1; j < start[v + 1]; ++j)
+            {
+                lg.edges.emplace_back(incident[i], incident[j]);
+            }
+        }
+    }
+}
+
+namespace internal
+{
+// line graph of g in a flat form. Edges of g are numbered 0..m-1 and become the vertices of the line graph.
+// Instead of an adjacency list, each vertex of g keeps the bitset of its incident edges (a clique of the line
+// graph), neighbours of the edge e are then the union of the two stars of its end vertices.
+class EcdLineGraph
+{
+  public:
+    typedef uint64_t Word;
+    static constexpr int word_bits = 64;
+
+    explicit EcdLineGraph(const Graph& g)
+    {
+        int max_num = -1;
+        for(auto& r : g)
+        {
+            max_num = std::max(max_num, r.n().to_int());
+        }
+        std::vector<int> vert_index(max_num + 1, -1);
+        for(auto& r : g)
+        {
+            vert_index[r.n().to_int()] = n++;
+        }
+
+        for(auto& r : g)
+        {
+            for(auto& i : r)
+            {
+                if(!i.is_primary())
+                {
+                    continue;
+                }
+                edges.push_back(i.e());
+                ends.push_back(vert_index[i.n1().to_int()]);
+                ends.push_back(vert_index[i.n2().to_int()]);
+            }
+        }
+        build();
+    }
+
+    // there are no Edge objects then, edge() cannot be used
+    explicit EcdLineGraph(const EdgeList& g) : n(g.n)
+    {
+        ends.reserve(2 * g.edges.size());
+        for(auto& [u, v] : g.edges)
+        {
+            ends.push_back(u);
+            ends.push_back(v);
+        }
+        build();
+    }
+
+    int size() const
+    {
+        return m;
+    }
+
+    int order() const
+    {
+        return n;
+    }
+
+    int degree(int v) const
+    {
+        return degrees[v];
+    }
+
+    int maxDegree() const
+    {
+        return n ? *std::max_element(degrees.begin(), degrees.end()) : 0;
+    }
+
+    bool hasParallelEdge() const
+    {
+        std::vector<std::pair<int, int>> pairs;
+        for(int e = 0; e < m; ++e)
+        {
+            pairs.push_back(std::minmax(ends[2 * e], ends[2 * e + 1]));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        return std::adjacent_find(pairs.begin(), pairs.end()) != pairs.end();
+    }
+
+    int wordCount() const
+    {
+        return words;
+    }
+
+    int end(int e, int side) const
+    {
+        return ends[2 * e + side];
+    }
+
+    const Edge& edge(int e) const
+    {
+        return edges[e];
+    }
+
+    // bitset of edges incident with the vertex v
+    const Word* star(int v) const
+    {
+        return &stars[(size_t)v * words];
+    }
+
+    static void set(Word* bits, int e)
+    {
+        bits[e / word_bits] |= Word(1) << (e % word_bits);
+    }
+
+    static void reset(Word* bits, int e)
+    {
+        bits[e / word_bits] &= ~(Word(1) << (e % word_bits));
+    }
+
+    static bool test(const Word* bits, int e)
+    {
+        return (bits[e / word_bits] >> (e % word_bits)) & 1;
+    }
+
+  protected:
+    int n = 0;
+    int m = 0;
+    int words = 0;
+    std::vector<Edge> edges;
+    std::vector<int> ends;    // end vertices of the edge e are ends[2*e], ends[2*e+1]
+    std::vector<Word> stars;  // words consecutive words for each vertex
+    std::vector<int> degrees;
+
+    void build()
+    {
+        m = (int)ends.size() / 2;
+        words = (m + word_bits - 1) / word_bits;
+        stars.resize((size_t)n * words, 0);
+        degrees.resize(n, 0);
+        for(int e = 0; e < m; ++e)
+        {
+            set(star(ends[2 * e]), e);
+            set(star(ends[2 * e + 1]), e);
+            degrees[ends[2 * e]]++;
+            degrees[ends[2 * e + 1]]++;
+        }
+    }
+
+    Word* star(int v)
+    {
+        return &stars[(size_t)v * words];
+    }
+};
+
+// color classes of the coloring (class c has colors 2*c, 2*c+1) as subgraphs of g
+inline std::vector<Graph> ecd_subgraphs_from_coloring(const Graph& g, const EcdLineGraph& lg, const std::vector<int>& coloring,
+                                                      int size, Factory& f = static_factory)
+{
+    std::vector<Graph> subgraphs;
+    for(int i = 0; i < size; ++i)
+    {
+        subgraphs.emplace_back(createG(f));
+    }
+
+    for(int i = 0; i < lg.size(); ++i)
+    {
+        const Edge& e = lg.edge(i);
+        Graph& subg = subgraphs[coloring[i] / 2];
+
+        if(!subg.contains(RP::v(e.v1())))
+        {
+            addV(subg, e.v1(), g.find(RP::v(e.v1()))->n(), f);
+        }
+        if(!subg.contains(RP::v(e.v2())))
+        {
+            addV(subg, e.v2(), g.find(RP::v(e.v2()))->n(), f);
+        }
+        addE(subg, e, f);
+    }
+
+    return subgraphs;
+}
+}  // namespace internal
+}  // namespace ba_graph
+#endif
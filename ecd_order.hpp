@@ -0,0 +1,105 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_ORDER_HPP
+#define BA_GRAPH_INVARIANTS_ECD_ORDER_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace ba_graph
+{
+// order in which the backtracking picks the edge starting the next cycle
+enum class EcdOrder
+{
+    numeric,      // the smallest number
+    bfs,          // breadth first search over adjacent edges from the first edge
+    constrained,  // the most colored adjacent edges, the smallest number on ties
+    degree,       // the largest sum of the degrees of the ends, in the bfs order on ties
+    random,       // a random permutation, restarted with another one when the nodes run out
+};
+
+struct EcdOrdering
+{
+    EcdOrder order = EcdOrder::numeric;
+    uint32_t seed = 0;
+    // nodes of the first random run, every restart gets twice as many, so the last run completes the search
+    long long restart_nodes = 100000;
+};
+
+namespace internal
+{
+// edges of lg in the static order, for the constrained order the numeric one
+inline std::vector<int> ecd_edge_order(const EcdLineGraph& lg, EcdOrder order, uint32_t seed)
+{
+    int m = lg.size();
+    std::vector<int> edges(m);
+    if(order == EcdOrder::numeric || order == EcdOrder::constrained)
+    {
+        for(int e = 0; e < m; ++e)
+        {
+            edges[e] = e;
+        }
+        return edges;
+    }
+    if(order == EcdOrder::random)
+    {
+        // Fisher-Yates with the generator of the seed, the same on every platform unlike std::shuffle
+        std::mt19937 rng(seed);
+        for(int e = 0; e < m; ++e)
+        {
+            edges[e] = e;
+        }
+        for(int i = m - 1; i > 0; --i)
+        {
+            std::swap(edges[i], edges[rng() % (uint32_t)(i + 1)]);
+        }
+        return edges;
+    }
+
+    // bfs from the first edge of every component
+    std::vector<bool> seen(m, false);
+    int head = 0, tail = 0;
+    for(int first = 0; first < m; ++first)
+    {
+        if(seen[first])
+        {
+            continue;
+        }
+        seen[first] = true;
+        edges[tail++] = first;
+        while(head < tail)
+        {
+            int e = edges[head++];
+            for(int side = 0; side < 2; ++side)
+            {
+                const EcdLineGraph::Word* star = lg.star(lg.end(e, side));
+                for(int w = 0; w < lg.wordCount(); ++w)
+                {
+                    EcdLineGraph::Word adj = star[w];
+                    while(adj)
+                    {
+                        int f = w * EcdLineGraph::word_bits + std::countr_zero(adj);
+                        adj &= adj - 1;
+                        if(!seen[f])
+                        {
+                            seen[f] = true;
+                            edges[tail++] = f;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    if(order == EcdOrder::degree)
+    {
+        auto weight = [&](int e) { return lg.degree(lg.end(e, 0)) + lg.degree(lg.end(e, 1)); };
+        std::stable_sort(edges.begin(), edges.end(), [&](int a, int b) { return weight(a) > weight(b); });
+    }
+    return edges;
+}
+}  // namespace internal
+}  // namespace ba_graph
+#endif
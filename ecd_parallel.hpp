@@ -0,0 +1,191 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_PARALLEL_HPP
+#define BA_GRAPH_INVARIANTS_ECD_PARALLEL_HPP
+
+#include "ecd.hpp"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+namespace internal
+{
+// branch and bound of internal::Ecd on several threads. Every worker owns a deque of tasks, it takes tasks from
+// its back and steals from the front of the other deques when it runs out of work. A busy worker splits off
+// branches of startCycle as new tasks while some worker is idle. All workers prune with the shared incumbent.
+class EcdParallel
+{
+  public:
+    // g is only needed by getEcd
+    EcdParallel(const EcdLineGraph& lg, int threads, const Graph* g = nullptr, const EcdOrdering& ordering = {})
+    {
+        for(int i = 0; i < threads; ++i)
+        {
+            workers.emplace_back(std::make_unique<Worker>(*this, lg, g, ordering));
+        }
+        // splitting deep in the tree produces tiny tasks, cycles have at least 2 edges
+        max_split_depth = workers[0]->ecd.edgeCount() / 4;
+
+        if(!workers[0]->ecd.canHaveEcd() || !workers[0]->ecd.applyBounds())
+        {
+            return;
+        }
+
+        workers[0]->push({std::vector<int>(workers[0]->ecd.edgeCount(), -1), 0, -1, 0});
+
+        std::vector<std::thread> pool;
+        for(int i = 0; i < threads; ++i)
+        {
+            pool.emplace_back([this, i]() { work(i); });
+        }
+        for(auto& t : pool)
+        {
+            t.join();
+        }
+    }
+
+    int getSize() const
+    {
+        return workers[0]->ecd.getSize();
+    }
+
+    std::vector<Graph> getEcd(Factory& f = static_factory)
+    {
+        return workers[0]->ecd.getEcd(f);
+    }
+
+  private:
+    struct Worker : public EcdSplitter
+    {
+        EcdParallel& pool;
+        Ecd ecd;
+        std::mutex mutex;
+        std::deque<EcdTask> tasks;
+
+        Worker(EcdParallel& pool, const EcdLineGraph& lg, const Graph* g, const EcdOrdering& ordering)
+            : pool(pool), ecd(lg, pool.best, this, g, ordering)
+        {
+        }
+
+        bool wantsTask(int depth) override
+        {
+            return depth <= pool.max_split_depth && pool.queued.load(std::memory_order_relaxed) < pool.idle.load(std::memory_order_relaxed);
+        }
+
+        void push(EcdTask task) override
+        {
+            pool.pending++;
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+            pool.queued++;
+        }
+    };
+
+    EcdIncumbent best;
+    std::vector<std::unique_ptr<Worker>> workers;
+    int max_split_depth = 0;
+    std::atomic<int> pending{0};  // tasks which are queued or running
+    std::atomic<int> queued{0};
+    std::atomic<int> idle{0};
+
+    bool pop(int id, EcdTask& task)
+    {
+        Worker& w = *workers[id];
+        std::lock_guard<std::mutex> lock(w.mutex);
+        if(w.tasks.empty())
+        {
+            return false;
+        }
+        task = std::move(w.tasks.back());
+        w.tasks.pop_back();
+        queued--;
+        return true;
+    }
+
+    bool steal(int id, EcdTask& task)
+    {
+        for(size_t i = 1; i < workers.size(); ++i)
+        {
+            Worker& w = *workers[(id + i) % workers.size()];
+            std::lock_guard<std::mutex> lock(w.mutex);
+            if(!w.tasks.empty())
+            {
+                task = std::move(w.tasks.front());
+                w.tasks.pop_front();
+                queued--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(int id)
+    {
+        bool is_idle = false;
+        EcdTask task;
+        while(true)
+        {
+            if(pop(id, task) || steal(id, task))
+            {
+                if(is_idle)
+                {
+                    idle--;
+                    is_idle = false;
+                }
+                workers[id]->ecd.run(task);
+                pending--;
+                continue;
+            }
+
+            if(pending.load() == 0)
+            {
+                break;
+            }
+            if(!is_idle)
+            {
+                idle++;
+                is_idle = true;
+            }
+            std::this_thread::yield();
+        }
+    }
+};
+}  // namespace internal
+
+// minimal size of the Ecd computed by the given number of threads, if there is none, return -1
+inline int ecd_size(const EdgeList& g, int threads, const EcdOrdering& ordering = {})
+{
+    if(threads <= 1)
+    {
+        return ecd_size(g, ordering);
+    }
+    return internal::ecd_size_by_blocks(g, [&](const EdgeList& block) {
+        internal::EcdParallel ecd(internal::EcdLineGraph(block), threads, nullptr, ordering);
+        return ecd.getSize();
+    });
+}
+
+inline int ecd_size(const Graph& g, int threads, const EcdOrdering& ordering = {})
+{
+    return ecd_size(edge_list(g), threads, ordering);
+}
+
+// get the subgraphs which make up the ecd using the given number of threads. If no ecd, returns {}
+inline std::vector<Graph> ecd_subgraphs(const Graph& g, int threads, Factory& f = static_factory,
+                                        const EcdOrdering& ordering = {})
+{
+    if(threads <= 1)
+    {
+        return ecd_subgraphs(g, f, ordering);
+    }
+    internal::EcdParallel ecd(internal::EcdLineGraph(g), threads, &g, ordering);
+
+    return ecd.getEcd(f);
+}
+}  // namespace ba_graph
+#endif
@@ -0,0 +1,103 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_PORTFOLIO_HPP
+#define BA_GRAPH_INVARIANTS_ECD_PORTFOLIO_HPP
+
+#include "ecd.hpp"
+#include "ecd_sat.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ba_graph
+{
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+// sat configurations raced against the backtracking by default
+inline const std::vector<EcdEncoding> ecd_portfolio_default = {
+  {AmoEncoding::pairwise, false, SymmetryBreaking::graph},
+  {AmoEncoding::pairwise, false, SymmetryBreaking::breakid},
+  {AmoEncoding::sequential, true, SymmetryBreaking::graph},
+};
+
+namespace internal
+{
+// minimal size of the ecd (-1 if there is none) by the backtracking and the incremental sat with each of the
+// configurations, every one on its own thread. The first answer is taken and the other searches are cancelled.
+// Racers beyond the number of cores only slow the others down, so only the first configurations are used then
+inline int ecd_size_portfolio(const EcdLineGraph& lg, const std::vector<EcdEncoding>& configurations)
+{
+    size_t racing = std::min<size_t>(configurations.size(), std::max(1u, std::thread::hardware_concurrency()) - 1);
+    racing = std::max<size_t>(racing, std::min<size_t>(configurations.size(), 1));
+
+    EcdCancel cancel;
+    std::atomic<bool> answered{false};
+    int result = -1;
+    // a cancelled search only returns after the winner has set answered, so its result is dropped
+    auto finish = [&](int size) {
+        if(!answered.exchange(true))
+        {
+            result = size;
+            cancel.cancel();
+        }
+    };
+
+    // every racer works on its own copy of lg
+    EcdIncumbent best;
+    best.cancelOn(cancel.flag());
+    Ecd ecd(lg, best);
+    std::vector<EcdLineGraph> lgs(racing, lg);
+    // the sat racers count into their own stats, added to those of this thread at the end
+    std::vector<EcdStats> stats(racing);
+    EcdStats* stats_target = ecd_stats();
+
+    std::vector<std::thread> racers;
+    racers.emplace_back([&]() {
+        if(ecd.canHaveEcd() && ecd.applyBounds())
+        {
+            ecd.run({std::vector<int>(ecd.edgeCount(), -1), 0, -1, 0});
+        }
+        finish(ecd.getSize());
+    });
+    for(size_t i = 0; i < racing; ++i)
+    {
+        racers.emplace_back([&, i]() {
+            const EcdEncoding& encoding = configurations[i];
+            std::optional<EcdStatsScope> scope;
+            if(stats_target)
+            {
+                scope.emplace(stats[i]);
+            }
+            finish(ecd_size_sat_incremental(lgs[i], encoding.symmetry != SymmetryBreaking::none, encoding, nullptr, &cancel));
+        });
+    }
+    for(auto& t : racers)
+    {
+        t.join();
+    }
+    if(stats_target)
+    {
+        for(auto& s : stats)
+        {
+            stats_target->merge(s);
+        }
+    }
+
+    return result;
+}
+}  // namespace internal
+
+inline int ecd_size_portfolio(const EdgeList& g, const std::vector<EcdEncoding>& configurations = ecd_portfolio_default)
+{
+    return internal::ecd_size_by_blocks(
+      g, [&](const EdgeList& block) { return internal::ecd_size_portfolio(internal::EcdLineGraph(block), configurations); });
+}
+
+inline int ecd_size_portfolio(const Graph& g, const std::vector<EcdEncoding>& configurations = ecd_portfolio_default)
+{
+    return ecd_size_portfolio(edge_list(g), configurations);
+}
+#endif
+}  // namespace ba_graph
+#endif
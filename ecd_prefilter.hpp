@@ -0,0 +1,119 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_PREFILTER_HPP
+#define BA_GRAPH_INVARIANTS_ECD_PREFILTER_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+// necessary conditions for an ecd checked in linear time, in the order they are tried
+enum class EcdFilter
+{
+    none,           // all passed, only a search decides
+    odd_size,       // odd number of edges
+    loop,           // a loop is not on an even cycle
+    odd_degree,     // every cycle through a vertex uses two of its edges
+    odd_component,  // each component has its own ecd, so it has an even number of edges
+};
+// a bridge is not on any cycle, but it leaves a vertex of odd degree on each side, so it needs no filter of its own
+
+inline const char* ecd_filter_name(EcdFilter filter)
+{
+    switch(filter)
+    {
+        case EcdFilter::none:
+            return "none";
+        case EcdFilter::odd_size:
+            return "odd_size";
+        case EcdFilter::loop:
+            return "loop";
+        case EcdFilter::odd_degree:
+            return "odd_degree";
+        case EcdFilter::odd_component:
+            return "odd_component";
+    }
+    return "";
+}
+
+namespace internal
+{
+// end(e) gives the pair of end vertices of the edge e
+template <typename End>
+inline EcdFilter ecd_prefilter(int n, int m, End end)
+{
+    if(m & 1)
+    {
+        return EcdFilter::odd_size;
+    }
+    std::vector<int> degree(n, 0);
+    for(int e = 0; e < m; ++e)
+    {
+        auto [u, v] = end(e);
+        if(u == v)
+        {
+            return EcdFilter::loop;
+        }
+        degree[u]++;
+        degree[v]++;
+    }
+    for(int v = 0; v < n; ++v)
+    {
+        if(degree[v] & 1)
+        {
+            return EcdFilter::odd_degree;
+        }
+    }
+
+    // the parity of the number of edges of each component by union-find
+    std::vector<int> parent(n);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v) {
+        while(parent[v] != v)
+        {
+            v = parent[v] = parent[parent[v]];
+        }
+        return v;
+    };
+    std::vector<char> odd(n, 0);
+    for(int e = 0; e < m; ++e)
+    {
+        auto [u, v] = end(e);
+        int a = find(u), b = find(v);
+        if(a != b)
+        {
+            parent[a] = b;
+            odd[b] ^= odd[a];
+        }
+        odd[b] ^= 1;
+    }
+    for(int v = 0; v < n; ++v)
+    {
+        if(parent[v] == v && odd[v])
+        {
+            return EcdFilter::odd_component;
+        }
+    }
+    return EcdFilter::none;
+}
+
+inline EcdFilter ecd_prefilter(const EcdLineGraph& lg)
+{
+    return ecd_prefilter(lg.order(), lg.size(), [&](int e) { return std::make_pair(lg.end(e, 0), lg.end(e, 1)); });
+}
+}  // namespace internal
+
+// the first necessary condition of an ecd which g fails, EcdFilter::none if it passes all of them
+inline EcdFilter ecd_prefilter(const EdgeList& g)
+{
+    return internal::ecd_prefilter(g.order(), g.size(), [&](int e) { return g.edges[e]; });
+}
+
+inline EcdFilter ecd_prefilter(const Graph& g)
+{
+    return ecd_prefilter(edge_list(g));
+}
+}  // namespace ba_graph
+#endif
@@ -6,166 +6,387 @@
 #include "sat/cnf.hpp"
 #include "sat/exec_solver.hpp"
 #include "sat/solver.hpp"
+#include "cardinality_cnf.hpp"
+#include "ecd_automorphisms.hpp"
 #include "preprocess_breakid.hpp"
+#include "ecd_blocks.hpp"
+#include "ecd_bounds.hpp"
+#include "ecd_prefilter.hpp"
+#include "ecd_stats.hpp"
 #include <impl/basic/include.hpp>
-#include <map>
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+#include <cryptominisat5/cryptominisat.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
 namespace ba_graph
 {
+enum class SymmetryBreaking
+{
+    graph,    // clauses from the automorphisms of the graph and the interchangeable color classes
+    breakid,  // symmetries detected by breakid on every cnf
+    none
+};
+
+// how the cardinality constraints and symmetry breaking of the ecd cnf are encoded
+struct EcdEncoding
+{
+    AmoEncoding at_most_one = AmoEncoding::pairwise;  // each edge belongs to at most one color class
+    bool exactly_two = false;  // redundant clauses, each vertex is incident to 0 or 2 edges of every color class
+    SymmetryBreaking symmetry = SymmetryBreaking::graph;  // used when symmetry breaking is on
+};
+
 namespace internal
 {
+// variables of cnf_ecd, the i-th edge has variables color[i][c] = i*(k+1)+c and even_pos[i] = i*(k+1)+k,
+// auxiliary variables of the encodings follow after them
+inline int ecd_color_var(int edge, int c, int k)
+{
+    return edge * (k + 1) + c;
+}
 
-inline CNF cnf_ecd(const Graph& g, int k)
+inline int ecd_even_var(int edge, int k)
 {
-    if(k == 0)
+    return edge * (k + 1) + k;
+}
+
+// calls f(e) for the edges e of the bitset star in increasing order
+template <typename F>
+inline void ecd_for_star(const EcdLineGraph& lg, const EcdLineGraph::Word* star, F f)
+{
+    for(int w = 0; w < lg.wordCount(); ++w)
     {
-        return g.size() ? cnf_unsatisfiable : cnf_satisfiable;
+        for(EcdLineGraph::Word bits = star[w]; bits; bits &= bits - 1)
+        {
+            f(w * EcdLineGraph::word_bits + std::countr_zero(bits));
+        }
     }
-    if(g.size() == 0)
+}
+
+// cnf_ecd written straight into one literal arena, edges are the indices of lg
+inline FlatCNF flat_cnf_ecd(const EcdLineGraph& lg, int k, const EcdEncoding& encoding = {})
+{
+    FlatCNF cnf;
+    int m = lg.size();
+    if(m == 0)
     {
-        return cnf_satisfiable;
+        return cnf;
     }
+    if(k == 0)
+    {
+        cnf.vars = 1;
+        cnf.add({FlatCNF::lit(0, false)});
+        cnf.add({FlatCNF::lit(0, true)});
+        return cnf;
+    }
+    cnf.vars = m * (k + 1);
 
-    auto edges = g.list(RP::all(), IP::primary(), IT::l());
-    // color[e][c]=true iff edge e belongs to the c-th color class
-    std::map<Location, std::vector<int>> color;
-    // even_pos[e]=true iff edge is even position in its color class
-    std::map<Location, int> even_pos;
+    long long pairs = 0, star_lits = 0;
+    for(int v = 0; v < lg.order(); ++v)
+    {
+        long long d = lg.degree(v);
+        pairs += d * (d - 1) / 2;
+        star_lits += d * d;
+    }
+    cnf.reserve(m + (size_t)m * k * (k - 1) / 2 + 2 * k * pairs + 2 * (size_t)m * k,
+                (size_t)m * k + (size_t)m * k * (k - 1) + 8 * k * pairs + k * star_lits);
 
-    std::vector<Clause> cnf;
+    auto color = [k](int e, int c, bool neg) { return FlatCNF::lit(ecd_color_var(e, c, k), neg); };
+    auto even = [k](int e, bool neg) { return FlatCNF::lit(ecd_even_var(e, k), neg); };
 
-    int next_var = 0;
-    for(auto& l : edges)
+    // each edge belongs to at least one color class
+    for(int e = 0; e < m; ++e)
     {
-        std::vector<int> v(k);
         for(int c = 0; c < k; ++c)
         {
-            v[c] = next_var++;
+            cnf.push(ecd_color_var(e, c, k), false);
         }
+        cnf.close();
+    }
 
-        color[l] = v;
-        even_pos[l] = next_var++;
+    // each edge belongs to at most one color class
+    std::vector<uint32_t> lits;
+    for(int e = 0; e < m; ++e)
+    {
+        lits.clear();
+        for(int c = 0; c < k; ++c)
+        {
+            lits.push_back(color(e, c, false));
+        }
+        at_most_one(cnf, lits, encoding.at_most_one);
     }
 
-    // each edge belongs to at least one color class
-    for(auto& l : edges)
+    // if adjacent belong to the same color class they must have opposite parity
+    for(int v = 0; v < lg.order(); ++v)
     {
-        std::vector<Lit> clause;
+        ecd_for_star(lg, lg.star(v), [&](int e) {
+            int u = lg.end(e, 0) == v ? lg.end(e, 1) : lg.end(e, 0);
+            ecd_for_star(lg, lg.star(v), [&](int f) {
+                if(f <= e)
+                {
+                    return;
+                }
+                // parallel edges meet at both ends, the clauses are added only at the smaller one
+                int w = lg.end(f, 0) == v ? lg.end(f, 1) : lg.end(f, 0);
+                if(u == w && u < v)
+                {
+                    return;
+                }
+                for(int c = 0; c < k; ++c)
+                {
+                    // exactly one must be on even pos
+                    cnf.add({color(e, c, true), color(f, c, true), even(e, true), even(f, true)});
+                    cnf.add({color(e, c, true), color(f, c, true), even(e, false), even(f, false)});
+                }
+            });
+        });
+    }
 
-        for(int c = 0; c < k; ++c)
+    // each edge endpoint has to be incident to at least one edge in the same color class
+    for(int e = 0; e < m; ++e)
+    {
+        for(int side = 0; side < 2; ++side)
         {
-            clause.push_back(Lit(color[l][c], false));
+            for(int c = 0; c < k; ++c)
+            {
+                cnf.push(ecd_color_var(e, c, k), true);
+                ecd_for_star(lg, lg.star(lg.end(e, side)), [&](int f) {
+                    if(f != e)
+                    {
+                        cnf.push(ecd_color_var(f, c, k), false);
+                    }
+                });
+                cnf.close();
+            }
         }
-        cnf.push_back(clause);
     }
 
-    // each edge belongs to at most one color class
-    for(auto& l : edges)
+    // together with the clauses above, no vertex has 1 edge of a color class, so this makes it 0 or 2
+    if(encoding.exactly_two)
     {
-        for(int c1 = 0; c1 < k; ++c1)
+        for(int v = 0; v < lg.order(); ++v)
         {
-            for(int c2 = c1 + 1; c2 < k; ++c2)
+            for(int c = 0; c < k; ++c)
             {
-                cnf.push_back(Clause{Lit(color[l][c1], true), Lit(color[l][c2], true)});
+                lits.clear();
+                ecd_for_star(lg, lg.star(v), [&](int e) { lits.push_back(color(e, c, false)); });
+                at_most_sequential(cnf, lits, 2);
             }
         }
     }
 
-    // // each edge belongs to at most one parity
-    // for(auto& l : edges)
-    // {
-    //     cnf.push_back(Clause{Lit(parity[l][0], true), Lit(parity[l][1], true)});
-    // }
+    return cnf;
+}
 
-    // if adjacent belong to the same color class they must have opposite parity
-    for(auto& l : edges)
+inline CNF cnf_ecd(const Graph& g, int k)
+{
+    return flat_cnf_ecd(EcdLineGraph(g), k).toCNF();
+}
+
+// symmetry breaking clauses for the cnf of any k. Every solution can be mapped by a symmetry to the lexicographically
+// largest one (in the order of variables, true > false) of its orbit, the clauses only keep such solutions:
+// - the color classes are interchangeable: the class of an edge is at most one more than the classes of the edges
+//   before it and the first edge of each class is on an even position
+// - for each automorphism generator p, the assignment is not smaller than the one permuted by p, compared on
+//   at most lex_length moved variables like breakid does
+// the automorphisms of the graph are computed once for all k
+class EcdSymmetryBreaker
+{
+  public:
+    static constexpr int lex_length = 50;
+
+    EcdSymmetryBreaker(const EcdLineGraph& lg, SymmetryBreaking method) : lg(lg), method(method) {}
+
+    void apply(FlatCNF& cnf, int k)
     {
-        for(auto& n : {l.n1(), l.n2()})
+        int vars = cnf.vars;
+        auto start = std::chrono::steady_clock::now();
+        applyMethod(cnf, k);
+        if(EcdStats* stats = ecd_stats())
         {
-            for(auto& i : g[n])
+            stats->symmetry_vars = std::max(stats->symmetry_vars, cnf.vars - vars);
+            stats->symmetry_time += ecd_seconds_since(start);
+        }
+    }
+
+  private:
+    const EcdLineGraph& lg;
+    SymmetryBreaking method;
+    std::unique_ptr<EcdAutomorphisms> aut;
+
+    void applyMethod(FlatCNF& cnf, int k)
+    {
+        if(method == SymmetryBreaking::breakid)
+        {
+            preprocess_breakid(cnf);
+            return;
+        }
+        if(method == SymmetryBreaking::none || k == 0 || lg.size() == 0)
+        {
+            return;
+        }
+        if(!aut)
+        {
+            aut = std::make_unique<EcdAutomorphisms>(lg);
+        }
+        colorPrecedence(cnf, k);
+        for(auto& p : aut->generators())
+        {
+            lexLeader(cnf, k, p);
+        }
+    }
+
+    void colorPrecedence(FlatCNF& cnf, int k)
+    {
+        // used[i][c] implies that one of the edges 0..i is in the class c
+        auto used = [k, first = cnf.vars](int i, int c, bool neg) { return FlatCNF::lit(first + i * k + c, neg); };
+        auto color = [k](int e, int c, bool neg) { return FlatCNF::lit(ecd_color_var(e, c, k), neg); };
+        cnf.vars += lg.size() * k;
+
+        cnf.add({color(0, 0, true), FlatCNF::lit(ecd_even_var(0, k), false)});
+        for(int c = 0; c < k; ++c)
+        {
+            cnf.add({used(0, c, true), color(0, c, false)});
+            if(c > 0)
             {
-                Location l2 = i.is_primary() ? i.l() : i.jump().l();
-                if(l2 == l || color[l][0] > color[l2][0])
-                {
-                    continue;
-                }
-                for(int c = 0; c < k; ++c)
+                cnf.add({color(0, c, true)});
+            }
+        }
+        for(int i = 1; i < lg.size(); ++i)
+        {
+            for(int c = 0; c < k; ++c)
+            {
+                cnf.add({used(i, c, true), used(i - 1, c, false), color(i, c, false)});
+                if(c > 0)
                 {
-                    // exactly one must be on even pos
-                    cnf.push_back(Clause{Lit(color[l][c], true), Lit(color[l2][c], true), Lit(even_pos[l], true), Lit(even_pos[l2], true)});
-                    cnf.push_back(Clause{Lit(color[l][c], true), Lit(color[l2][c], true), Lit(even_pos[l], false), Lit(even_pos[l2], false)});
+                    cnf.add({color(i, c, true), used(i - 1, c - 1, false)});
                 }
+                cnf.add({color(i, c, true), used(i - 1, c, false), FlatCNF::lit(ecd_even_var(i, k), false)});
             }
         }
     }
 
-    // each edge endpoint has to be incident to at least one edge in the same color class
-    for(auto& l : edges)
+    void lexLeader(FlatCNF& cnf, int k, const std::vector<int>& p)
     {
-        for(auto& n : {l.n1(), l.n2()})
+        // pairs of variables x, y = p(x) compared, the variables of fixed edges are always equal
+        std::vector<std::pair<int, int>> compared;
+        for(int e = 0; e < lg.size() && (int)compared.size() < lex_length; ++e)
         {
-            for(int c = 0; c < k; ++c)
+            for(int r = 0; r <= k && p[e] != e && (int)compared.size() < lex_length; ++r)
             {
-                // for(int p = 0; p < 2; ++p)
-                // {
-                //     std::vector<Clause> dnf;
-                //     dnf.push_back(Clause{Lit(color[l][c], true)});
-                //     dnf.push_back(Clause{Lit(parity[l][p], true)});
-
-                std::vector<Lit> clause = {Lit(color[l][c], true)};
-                for(auto& i : g[n])
-                {
-                    Location l2 = i.is_primary() ? i.l() : i.jump().l();
-                    if(l == l2)
-                    {
-                        continue;
-                    }
+                compared.emplace_back(e * (k + 1) + r, p[e] * (k + 1) + r);
+            }
+        }
+
+        // eq implies that the compared variables before the current one are equal
+        int eq = -1;
+        for(size_t i = 0; i < compared.size(); ++i)
+        {
+            auto [x, y] = compared[i];
+            if(eq != -1)
+            {
+                cnf.push(eq, true);
+            }
+            cnf.push(x, false);
+            cnf.push(y, true);
+            cnf.close();
 
-                    clause.push_back(Lit(color[l2][c], false));
-                    // dnf.push_back(Clause{Lit(color[l2][c], false), Lit(parity[l2][p ^ 1], false)});
+            if(i + 1 == compared.size())
+            {
+                break;
+            }
+            int next = cnf.vars++;
+            for(bool value : {false, true})
+            {
+                if(eq != -1)
+                {
+                    cnf.push(eq, true);
                 }
-                cnf.push_back(clause);
-
-                // auto convert_cnf = dnf_to_cnf(dnf, next_var);
-                // for(auto& cl : convert_cnf)
-                // {
-                //     cnf.push_back(cl);
-                //     for(auto& lit : cl)
-                //     {
-                //         next_var = std::max(next_var, lit.var());
-                //     }
-                // }
+                cnf.push(x, value);
+                cnf.push(y, value);
+                cnf.push(next, false);
+                cnf.close();
             }
+            eq = next;
         }
     }
+};
+
+// the size of the cnf for the stats of this thread
+inline void ecd_count_cnf(const FlatCNF& cnf)
+{
+    if(EcdStats* stats = ecd_stats())
+    {
+        stats->vars = std::max(stats->vars, cnf.vars);
+        stats->clauses = std::max(stats->clauses, (long long)cnf.size());
+    }
+}
 
-    return {next_var, cnf};
+inline bool has_ecd_size_sat(const SatSolver& solver, const EcdLineGraph& lg, int k, EcdSymmetryBreaker& symmetry,
+                             const EcdEncoding& encoding)
+{
+    FlatCNF cnf = flat_cnf_ecd(lg, k, encoding);
+    symmetry.apply(cnf, k);
+    ecd_count_cnf(cnf);
+
+    auto start = std::chrono::steady_clock::now();
+    bool sat = satisfiable(solver, cnf.toCNF());
+    if(EcdStats* stats = ecd_stats())
+    {
+        stats->probes.push_back({k, sat, ecd_seconds_since(start), -1});
+    }
+    return sat;
 }
 }  // namespace internal
 
-inline bool has_ecd_size_sat(const SatSolver& solver, const Graph& g, int k, bool break_symmetry = true)
+inline bool has_ecd_size_sat(const SatSolver& solver, const Graph& g, int k, bool break_symmetry = true,
+                             const EcdEncoding& encoding = {})
 {
-    CNF cnf = internal::cnf_ecd(g, k);
-    if(break_symmetry)
+    internal::EcdLineGraph lg(g);
+    internal::EcdSymmetryBreaker symmetry(lg, break_symmetry ? encoding.symmetry : SymmetryBreaking::none);
+
+    return internal::has_ecd_size_sat(solver, lg, k, symmetry, encoding);
+}
+
+namespace internal
+{
+// ecd_bounds with its time counted in the stats of this thread
+inline EcdBounds ecd_bounds_timed(const EcdLineGraph& lg)
+{
+    auto start = std::chrono::steady_clock::now();
+    EcdBounds bounds = ecd_bounds(lg);
+    if(EcdStats* stats = ecd_stats())
     {
-        cnf = preprocess_breakid(cnf);
+        stats->bounds_time += ecd_seconds_since(start);
     }
-    return satisfiable(solver, cnf);
+    return bounds;
 }
 
-inline int ecd_size_sat(const SatSolver& solver, const Graph& g)
+// binary search for the minimal k with has_ecd(k) inside the bounds
+template <typename Probe>
+inline int ecd_size_search(const EcdBounds& bounds, Probe has_ecd)
 {
     // search space (l,r]
-    int l = min_deg(g) == 4 && max_deg(g) == 4 ? 1 : -1;
-    int div_constant = has_parallel_edge(g) ? 2 : 4;
-    int r = g.size() / div_constant;
+    int l = bounds.lower - 1;
+    int r = bounds.upper;
+    if(r < bounds.lower)
+    {
+        return -1;
+    }
 
     while(r - l > 1)
     {
         int m = (l + r) / 2;
-        if(has_ecd_size_sat(solver, g, m))
+        if(has_ecd(m))
         {
             r = m;
         }
@@ -175,40 +396,310 @@ inline int ecd_size_sat(const SatSolver& solver, const Graph& g)
         }
     }
 
-    if(has_ecd_size_sat(solver, g, r))
+    // the greedy ecd already shows that r is enough
+    if(bounds.witnessed || has_ecd(r))
     {
         return r;
     }
     return -1;
+}
+
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+// lets another thread cancel running searches: the backtracking watches the flag, the registered solvers are interrupted
+class EcdCancel
+{
+  public:
+    const std::atomic<bool>* flag() const
+    {
+        return &stopped;
+    }
+
+    bool cancelled() const
+    {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    void cancel()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        for(auto solver : solvers)
+        {
+            solver->interrupt_asap();
+        }
+    }
+
+    // returns false if it is already cancelled
+    bool attach(CMSat::SATSolver* solver)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(stopped)
+        {
+            return false;
+        }
+        solvers.push_back(solver);
+        return true;
+    }
+
+    void detach(CMSat::SATSolver* solver)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        solvers.erase(std::find(solvers.begin(), solvers.end(), solver));
+    }
+
+  private:
+    std::atomic<bool> stopped{false};
+    std::mutex mutex;
+    std::vector<CMSat::SATSolver*> solvers;
+};
+
+// one CryptoMiniSat instance for all probes of the binary search. The cnf is encoded once for max_k color classes,
+// with a variable disabled[c] for each class that forbids its edges. Probe k assumes disabled[k], which disables
+// all the classes >= k, so the clauses learned in one probe are kept for the next ones
+class EcdIncrementalSat
+{
+  public:
+    // after cancel.cancel() every probe fails
+    EcdIncrementalSat(const EcdLineGraph& lg, int max_k, bool break_symmetry = true, const EcdEncoding& encoding = {},
+                      EcdCancel* cancel = nullptr)
+        : max_k(max_k), cancel(cancel)
+    {
+        if(cancel && !cancel->attach(&solver))
+        {
+            this->cancel = nullptr;
+            cancelled = true;
+            return;
+        }
+
+        FlatCNF cnf = flat_cnf_ecd(lg, max_k, encoding);
+        first_disabled = cnf.vars;
+        cnf.vars += max_k;
+
+        for(int c = 0; c < max_k; ++c)
+        {
+            for(int i = 0; i < lg.size(); ++i)
+            {
+                cnf.add({FlatCNF::lit(first_disabled + c, true), FlatCNF::lit(ecd_color_var(i, c, max_k), true)});
+            }
+            if(c + 1 < max_k)
+            {
+                cnf.add({FlatCNF::lit(first_disabled + c, true), FlatCNF::lit(first_disabled + c + 1, false)});
+            }
+        }
+        // the symmetries respect the order of disabled classes, so they stay sound under the assumptions
+        EcdSymmetryBreaker symmetry(lg, break_symmetry ? encoding.symmetry : SymmetryBreaking::none);
+        symmetry.apply(cnf, max_k);
+
+        ecd_count_cnf(cnf);
+        solver.new_vars(cnf.vars);
+        std::vector<CMSat::Lit> clause;
+        for(size_t i = 0; i < cnf.size(); ++i)
+        {
+            clause.clear();
+            for(const uint32_t* l = cnf.begin(i); l != cnf.end(i); ++l)
+            {
+                clause.push_back(CMSat::Lit(FlatCNF::var(*l), FlatCNF::neg(*l)));
+            }
+            solver.add_clause(clause);
+        }
+    }
+
+    ~EcdIncrementalSat()
+    {
+        if(cancel)
+        {
+            cancel->detach(&solver);
+        }
+    }
+
+    // the probes together may take at most max_conflicts conflicts, the next ones then fail
+    void limitConflicts(long long max_conflicts)
+    {
+        conflicts_left = max_conflicts;
+    }
+
+    bool hasEcd(int k)
+    {
+        if(cancelled || (cancel && cancel->cancelled()) || conflicts_left <= 0)
+        {
+            interrupted = true;
+            return false;
+        }
+        std::vector<CMSat::Lit> assumptions;
+        if(k < max_k)
+        {
+            assumptions.push_back(CMSat::Lit(first_disabled + k, false));
+        }
+        if(conflicts_left != LLONG_MAX)
+        {
+            solver.set_max_confl(conflicts_left);
+        }
+        auto start = std::chrono::steady_clock::now();
+        uint64_t conflicts = solver.get_sum_conflicts();
+        CMSat::lbool ret = solver.solve(&assumptions);
+        bool sat = ret == l_True;
+        long long used = (long long)(solver.get_sum_conflicts() - conflicts);
+        if(EcdStats* stats = ecd_stats())
+        {
+            stats->probes.push_back({k, sat, ecd_seconds_since(start), used});
+        }
+        if(conflicts_left != LLONG_MAX)
+        {
+            conflicts_left -= used;
+        }
+        // cancelled or out of conflicts
+        if(ret == l_Undef)
+        {
+            interrupted = true;
+        }
+        if(!sat)
+        {
+            return false;
+        }
+        model = solver.get_model();
+        return true;
+    }
+
+    // some probe failed without deciding, the result of the search is then meaningless
+    bool wasInterrupted() const
+    {
+        return interrupted;
+    }
+
+    // a satisfiable probe was made, the ecd of the last one can be read by getColoring
+    bool hasModel() const
+    {
+        return !model.empty();
+    }
+
+    // colors as in internal::Ecd, class c has colors 2*c (even position) and 2*c+1
+    std::vector<int> getColoring(const EcdLineGraph& lg) const
+    {
+        std::vector<int> coloring(lg.size(), -1);
+        for(int i = 0; i < lg.size(); ++i)
+        {
+            int parity = model[ecd_even_var(i, max_k)] == l_True ? 0 : 1;
+            for(int c = 0; c < max_k; ++c)
+            {
+                if(model[ecd_color_var(i, c, max_k)] == l_True)
+                {
+                    coloring[i] = 2 * c + parity;
+                    break;
+                }
+            }
+        }
+        return coloring;
+    }
+
+  private:
+    CMSat::SATSolver solver;
+    int max_k;
+    int first_disabled;
+    std::vector<CMSat::lbool> model;
+    EcdCancel* cancel;
+    bool cancelled = false;
+    long long conflicts_left = LLONG_MAX;
+    bool interrupted = false;
+};
+
+// ecd_size_sat_incremental, if coloring is given and there is an ecd, one of minimal size is stored there.
+// ecd_timeout if the search is cancelled or runs out of max_conflicts conflicts
+inline int ecd_size_sat_incremental(const EcdLineGraph& lg, bool break_symmetry, const EcdEncoding& encoding,
+                                    std::vector<int>* coloring = nullptr, EcdCancel* cancel = nullptr,
+                                    long long max_conflicts = LLONG_MAX)
+{
+    if(ecd_prefilter(lg) != EcdFilter::none)
+    {
+        return -1;
+    }
+    EcdBounds bounds = ecd_bounds_timed(lg);
+    // the bounds alone decide, there is no need to encode anything
+    if(bounds.upper < bounds.lower)
+    {
+        return -1;
+    }
+    if(bounds.witnessed && bounds.lower == bounds.upper)
+    {
+        if(coloring)
+        {
+            *coloring = bounds.coloring;
+        }
+        return bounds.upper;
+    }
+    EcdIncrementalSat sat(lg, bounds.upper, break_symmetry, encoding, cancel);
+    sat.limitConflicts(max_conflicts);
+
+    int size = ecd_size_search(bounds, [&](int k) { return sat.hasEcd(k); });
+    if(sat.wasInterrupted())
+    {
+        return ecd_timeout;
+    }
+    if(coloring && size != -1)
+    {
+        // every satisfiable probe lowers the size, so the last model is of the minimal size,
+        // without one the greedy ecd is the minimal
+        *coloring = sat.hasModel() ? sat.getColoring(lg) : bounds.coloring;
+    }
+    return size;
+}
+#endif
+}  // namespace internal
+
+namespace internal
+{
+inline int ecd_size_sat(const SatSolver& solver, const EcdLineGraph& lg, const EcdEncoding& encoding)
+{
+    if(ecd_prefilter(lg) != EcdFilter::none)
+    {
+        return -1;
+    }
+    EcdBounds bounds = ecd_bounds_timed(lg);
+    EcdSymmetryBreaker symmetry(lg, encoding.symmetry);
+
+    return ecd_size_search(bounds, [&](int k) { return has_ecd_size_sat(solver, lg, k, symmetry, encoding); });
+}
+}  // namespace internal
+
+// every block of g is encoded and solved on its own
+inline int ecd_size_sat(const SatSolver& solver, const EdgeList& g, const EcdEncoding& encoding = {})
+{
+    return internal::ecd_size_by_blocks(
+      g, [&](const EdgeList& block) { return internal::ecd_size_sat(solver, internal::EcdLineGraph(block), encoding); });
+}
+
+inline int ecd_size_sat(const SatSolver& solver, const Graph& g, const EcdEncoding& encoding = {})
+{
+    return ecd_size_sat(solver, edge_list(g), encoding);
+}
+
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+// ecd_size_sat which encodes the graph once and keeps one solver for the whole binary search
+inline int ecd_size_sat_incremental(const EdgeList& g, bool break_symmetry = true, const EcdEncoding& encoding = {})
+{
+    return internal::ecd_size_by_blocks(g, [&](const EdgeList& block) {
+        return internal::ecd_size_sat_incremental(internal::EcdLineGraph(block), break_symmetry, encoding);
+    });
+}
+
+inline int ecd_size_sat_incremental(const Graph& g, bool break_symmetry = true, const EcdEncoding& encoding = {})
+{
+    return ecd_size_sat_incremental(edge_list(g), break_symmetry, encoding);
+}
+
+// get the subgraphs which make up a minimal ecd, read from the model of the last satisfiable probe of
+// ecd_size_sat_incremental. If no ecd, returns {}
+inline std::vector<Graph> ecd_subgraphs_sat(const Graph& g, Factory& f = static_factory, const EcdEncoding& encoding = {})
+{
+    internal::EcdLineGraph lg(g);
+    std::vector<int> coloring;
+    int size = internal::ecd_size_sat_incremental(lg, true, encoding, &coloring);
+    if(size == -1)
+    {
+        return {};
+    }
 
-    // bool has_ecd = false;
-    // for(int k = r; k>l; --k)
-    // {
-    //     if(has_ecd_size_sat(solver, g, k))
-    //     {
-    //         has_ecd = true;
-    //     }
-    //     else
-    //     {
-    //         return has_ecd?k+1:-1;
-    //     }
-    // }
-    //
-    // if(has_ecd)
-    // {
-    //     return l+1;
-    // }
-    // return 0;
-
-    // for(int k = l + 1; k <= r; ++k)
-    // {
-    //     if(has_ecd_size_sat(solver, g, k))
-    //     {
-    //         return k;
-    //     }
-    // }
-    //
-    // return -1;
+    return internal::ecd_subgraphs_from_coloring(g, lg, coloring, size, f);
 }
+#endif
 }  // namespace ba_graph
 #endif  // BA_GRAPH_SAT_CNF_ECD_HPP
@@ -0,0 +1,106 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_STATS_HPP
+#define BA_GRAPH_INVARIANTS_ECD_STATS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ba_graph
+{
+// one probe "is there an ecd of size k" of the sat binary search
+struct EcdProbe
+{
+    int k;
+    bool satisfiable;
+    double time;             // seconds
+    long long conflicts;     // -1 if the solver does not report them
+};
+
+// counters of the ecd computations run on a thread while an EcdStatsScope is active on it. Compiling with
+// ECD_NO_STATS removes the counting
+struct EcdStats
+{
+    // backtracking
+    long long nodes = 0;           // calls of startCycle and findCycle
+    long long prune_conflict = 0;  // an edge with a neighbour of its color, or three of the other parity
+    long long prune_bound = 0;     // a new color class would not beat the incumbent
+    long long prune_forward = 0;   // an uncolored edge was left without any class it could join
+    long long prune_done = 0;      // the search was stopped (ecd within the limit found, lower bound reached or cancelled)
+    int max_depth = 0;             // most closed cycles on one branch
+    double bounds_time = 0;        // seconds
+    double search_time = 0;
+
+    // sat, the cnf sizes are those of the largest cnf
+    int vars = 0;
+    long long clauses = 0;
+    int symmetry_vars = 0;  // auxiliary variables of the symmetry breaking (by breakid or of the graph)
+    double symmetry_time = 0;
+    std::vector<EcdProbe> probes;
+
+    void merge(const EcdStats& o)
+    {
+        nodes += o.nodes;
+        prune_conflict += o.prune_conflict;
+        prune_bound += o.prune_bound;
+        prune_forward += o.prune_forward;
+        prune_done += o.prune_done;
+        max_depth = std::max(max_depth, o.max_depth);
+        bounds_time += o.bounds_time;
+        search_time += o.search_time;
+        vars = std::max(vars, o.vars);
+        clauses = std::max(clauses, o.clauses);
+        symmetry_vars = std::max(symmetry_vars, o.symmetry_vars);
+        symmetry_time += o.symmetry_time;
+        probes.insert(probes.end(), o.probes.begin(), o.probes.end());
+    }
+};
+
+#ifdef ECD_NO_STATS
+inline constexpr bool ecd_stats_enabled = false;
+#else
+inline constexpr bool ecd_stats_enabled = true;
+#endif
+
+namespace internal
+{
+inline thread_local EcdStats* ecd_stats_target = nullptr;
+
+// where the computations on this thread report, nullptr if nobody listens
+inline EcdStats* ecd_stats()
+{
+    if constexpr(!ecd_stats_enabled)
+    {
+        return nullptr;
+    }
+    return ecd_stats_target;
+}
+
+inline double ecd_seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+}  // namespace internal
+
+// collects the stats of the ecd computations on this thread into stats until it is destroyed
+class EcdStatsScope
+{
+  public:
+    explicit EcdStatsScope(EcdStats& stats) : previous(internal::ecd_stats_target)
+    {
+        internal::ecd_stats_target = &stats;
+    }
+
+    EcdStatsScope(const EcdStatsScope&) = delete;
+    EcdStatsScope& operator=(const EcdStatsScope&) = delete;
+
+    ~EcdStatsScope()
+    {
+        internal::ecd_stats_target = previous;
+    }
+
+  private:
+    EcdStats* previous;
+};
+}  // namespace ba_graph
+#endif
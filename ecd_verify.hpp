@@ -0,0 +1,227 @@
+#ifndef BA_GRAPH_INVARIANTS_ECD_VERIFY_HPP
+#define BA_GRAPH_INVARIANTS_ECD_VERIFY_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace ba_graph
+{
+namespace internal
+{
+// whether edge_class splits the edges into classes 0..classes-1 forming an ecd: each class is nonempty, has 0 or 2
+// edges at every vertex and is bipartite, so all its cycles are even. The ends of the edge e are end(e), vertices
+// are 0..n-1. Classes are checked one after another with union-find on their vertices, in O(m) up to the
+// inverse Ackermann factor
+template <typename End>
+inline bool is_ecd_coloring(int n, int m, const std::vector<int>& edge_class, int classes, End end)
+{
+    if((int)edge_class.size() != m)
+    {
+        return false;
+    }
+    // edges grouped by class with a counting sort
+    std::vector<int> start(classes + 1, 0);
+    for(int c : edge_class)
+    {
+        if(c < 0 || c >= classes)
+        {
+            return false;
+        }
+        start[c + 1]++;
+    }
+    for(int c = 0; c < classes; ++c)
+    {
+        start[c + 1] += start[c];
+    }
+    std::vector<int> by_class(m);
+    std::vector<int> pos(start.begin(), start.end() - 1);
+    for(int e = 0; e < m; ++e)
+    {
+        by_class[pos[edge_class[e]]++] = e;
+    }
+
+    std::vector<int> degree(n, 0);
+    // parity[v] is the side of v relative to parent[v]
+    std::vector<int> parent(n), parity(n, 0);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&](int v) {
+        int p = 0;
+        int root = v;
+        while(parent[root] != root)
+        {
+            p ^= parity[root];
+            root = parent[root];
+        }
+        // compress the path, every vertex on it gets its parity relative to the root
+        auto result = std::make_pair(root, p);
+        while(parent[v] != root)
+        {
+            int next = parent[v];
+            int next_p = p ^ parity[v];
+            parent[v] = root;
+            parity[v] = p;
+            v = next;
+            p = next_p;
+        }
+        return result;
+    };
+
+    for(int c = 0; c < classes; ++c)
+    {
+        if(start[c] == start[c + 1])
+        {
+            return false;
+        }
+        bool ok = true;
+        for(int i = start[c]; i < start[c + 1] && ok; ++i)
+        {
+            auto [u, v] = end(by_class[i]);
+            if(u == v || ++degree[u] > 2 || ++degree[v] > 2)
+            {
+                ok = false;
+                break;
+            }
+            auto [ru, pu] = find(u);
+            auto [rv, pv] = find(v);
+            if(ru == rv)
+            {
+                // closes a cycle, u and v have to be on different sides
+                ok = pu != pv;
+            }
+            else
+            {
+                parent[ru] = rv;
+                parity[ru] = pu ^ pv ^ 1;
+            }
+        }
+        for(int i = start[c]; i < start[c + 1]; ++i)
+        {
+            auto [u, v] = end(by_class[i]);
+            ok = ok && (degree[u] == 2 && degree[v] == 2);
+        }
+        // reset the touched vertices for the next class
+        for(int i = start[c]; i < start[c + 1]; ++i)
+        {
+            auto [u, v] = end(by_class[i]);
+            for(int x : {u, v})
+            {
+                degree[x] = 0;
+                parent[x] = x;
+                parity[x] = 0;
+            }
+        }
+        if(!ok)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// edges of g grouped by their smaller end with a counting sort, so an edge given by its ends is found by a scan of
+// the edges at one vertex. Each edge can be taken once
+class EcdEdgeBuckets
+{
+  public:
+    explicit EcdEdgeBuckets(const EdgeList& g) : start(g.order() + 1, 0), ids(g.size()), taken(g.size(), false)
+    {
+        for(auto [u, v] : g.edges)
+        {
+            start[std::min(u, v) + 1]++;
+        }
+        for(int u = 0; u < g.order(); ++u)
+        {
+            start[u + 1] += start[u];
+        }
+        std::vector<int> pos(start.begin(), start.end() - 1);
+        for(int e = 0; e < g.size(); ++e)
+        {
+            ids[pos[std::min(g.edges[e].first, g.edges[e].second)]++] = e;
+        }
+    }
+
+    // the first edge at the smaller of the ends u, v for which match holds, taken or not, -1 if there is none
+    template <typename Match>
+    int find(int u, int v, Match match) const
+    {
+        int w = std::min(u, v);
+        if(w < 0 || std::max(u, v) >= (int)start.size() - 1)
+        {
+            return -1;
+        }
+        for(int i = start[w]; i < start[w + 1]; ++i)
+        {
+            if(match(ids[i]))
+            {
+                return ids[i];
+            }
+        }
+        return -1;
+    }
+
+    // the first edge not yet taken for which match holds is taken, -1 if there is none
+    template <typename Match>
+    int take(int u, int v, Match match)
+    {
+        int e = find(u, v, [&](int e) { return !taken[e] && match(e); });
+        if(e >= 0)
+        {
+            taken[e] = true;
+        }
+        return e;
+    }
+
+    bool isTaken(int e) const
+    {
+        return taken[e];
+    }
+
+    void setTaken(int e)
+    {
+        taken[e] = true;
+    }
+
+  private:
+    std::vector<int> start;
+    std::vector<int> ids;
+    std::vector<bool> taken;
+};
+}  // namespace internal
+
+// whether classes (each a list of edges given by their ends) form an ecd of g. The edges of the classes have to be
+// exactly the edges of g, parallel edges are told apart only by their number. Each edge of a certificate takes the
+// first unused edge of g with the same ends, found in the bucket of its smaller end
+inline bool is_ecd_certificate(const EdgeList& g, const std::vector<std::vector<std::pair<int, int>>>& classes)
+{
+    internal::EcdEdgeBuckets buckets(g);
+    std::vector<int> edge_class(g.size(), -1);
+    int matched = 0;
+    for(int c = 0; c < (int)classes.size(); ++c)
+    {
+        for(auto [u, v] : classes[c])
+        {
+            int e = buckets.take(u, v, [&](int e) {
+                auto [a, b] = g.edges[e];
+                return std::max(a, b) == std::max(u, v);
+            });
+            if(e < 0)
+            {
+                return false;
+            }
+            edge_class[e] = c;
+            matched++;
+        }
+    }
+    if(matched != g.size())
+    {
+        return false;
+    }
+    return internal::is_ecd_coloring(g.order(), g.size(), edge_class, (int)classes.size(),
+                                     [&](int e) { return g.edges[e]; });
+}
+}  // namespace ba_graph
+#endif
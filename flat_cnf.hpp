@@ -0,0 +1,113 @@
+#ifndef FLAT_CNF_HPP
+#define FLAT_CNF_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+namespace ba_graph
+{
+// cnf kept in one contiguous arena of literals, clause i are the literals lits[offsets[i]] .. lits[offsets[i+1]-1].
+// A literal is stored as 2*var+neg, the same way as in CryptoMiniSat and BreakID
+class FlatCNF
+{
+  public:
+    int vars = 0;
+
+    FlatCNF() {}
+
+    explicit FlatCNF(const CNF& cnf) : vars(cnf.first)
+    {
+        offsets.reserve(cnf.second.size() + 1);
+        for(auto& cl : cnf.second)
+        {
+            for(auto& l : cl)
+            {
+                push(l.var(), l.neg());
+            }
+            close();
+        }
+    }
+
+    static uint32_t lit(int var, bool neg)
+    {
+        return 2 * (uint32_t)var + neg;
+    }
+
+    static int var(uint32_t lit)
+    {
+        return (int)(lit >> 1);
+    }
+
+    static bool neg(uint32_t lit)
+    {
+        return lit & 1;
+    }
+
+    void reserve(size_t clauses, size_t literals)
+    {
+        offsets.reserve(clauses + 1);
+        lits.reserve(literals);
+    }
+
+    // append a literal to the clause being built
+    void push(int var, bool neg)
+    {
+        lits.push_back(lit(var, neg));
+    }
+
+    // finish the clause being built
+    void close()
+    {
+        offsets.push_back(lits.size());
+    }
+
+    void add(std::initializer_list<uint32_t> clause)
+    {
+        lits.insert(lits.end(), clause.begin(), clause.end());
+        close();
+    }
+
+    // number of clauses
+    size_t size() const
+    {
+        return offsets.size() - 1;
+    }
+
+    size_t literals() const
+    {
+        return lits.size();
+    }
+
+    const uint32_t* begin(size_t clause) const
+    {
+        return lits.data() + offsets[clause];
+    }
+
+    const uint32_t* end(size_t clause) const
+    {
+        return lits.data() + offsets[clause + 1];
+    }
+
+    CNF toCNF() const
+    {
+        std::vector<Clause> clauses;
+        clauses.reserve(size());
+        for(size_t i = 0; i < size(); ++i)
+        {
+            Clause& cl = clauses.emplace_back();
+            cl.reserve(end(i) - begin(i));
+            for(const uint32_t* l = begin(i); l != end(i); ++l)
+            {
+                cl.push_back(Lit(var(*l), neg(*l)));
+            }
+        }
+        return {vars, clauses};
+    }
+
+  private:
+    std::vector<uint32_t> lits;
+    std::vector<size_t> offsets{0};
+};
+}  // namespace ba_graph
+#endif  // FLAT_CNF_HPP
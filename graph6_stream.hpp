@@ -0,0 +1,209 @@
+#ifndef GRAPH6_STREAM_HPP
+#define GRAPH6_STREAM_HPP
+
+#include "ecd_line_graph.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ba_graph
+{
+// decode one graph6 record into g, the buffers of g are reused
+inline void decode_graph6(std::string_view line, EdgeList& g)
+{
+    auto byte = [&](size_t i) -> int {
+        if(i >= line.size() || line[i] < 63 || line[i] > 126)
+        {
+            throw std::runtime_error("invalid graph6 record");
+        }
+        return line[i] - 63;
+    };
+
+    size_t pos = 0;
+    long long n = byte(0);
+    if(n == 63)
+    {
+        if(byte(1) == 63)
+        {
+            n = 0;
+            for(size_t i = 2; i < 8; ++i)
+            {
+                n = (n << 6) | byte(i);
+            }
+            pos = 8;
+        }
+        else
+        {
+            n = 0;
+            for(size_t i = 1; i < 4; ++i)
+            {
+                n = (n << 6) | byte(i);
+            }
+            pos = 4;
+        }
+    }
+    else
+    {
+        pos = 1;
+    }
+
+    g.n = (int)n;
+    g.edges.clear();
+    // upper triangle of the adjacency matrix column by column, 6 bits per byte from the most significant one
+    int bit = 0;
+    int cur = 0;
+    for(int v = 1; v < g.n; ++v)
+    {
+        for(int u = 0; u < v; ++u)
+        {
+            if(bit == 0)
+            {
+                cur = byte(pos++);
+                bit = 6;
+            }
+            --bit;
+            if((cur >> bit) & 1)
+            {
+                g.edges.emplace_back(u, v);
+            }
+        }
+    }
+}
+
+// strips the optional header and the line ending, false if no record is left
+inline bool graph6_record(std::string_view& line)
+{
+    if(!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    if(line.starts_with(">>graph6<<"))
+    {
+        line.remove_prefix(10);
+    }
+    return !line.empty();
+}
+
+// graph6 file mapped into memory and read record by record, nothing is copied apart from the decoded edges
+class Graph6Stream
+{
+  public:
+    explicit Graph6Stream(const std::string& file)
+    {
+        int fd = open(file.c_str(), O_RDONLY);
+        if(fd < 0)
+        {
+            throw std::runtime_error("cannot open " + file);
+        }
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            close(fd);
+            throw std::runtime_error("cannot stat " + file);
+        }
+        length = (size_t)st.st_size;
+        if(length > 0)
+        {
+            void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED)
+            {
+                close(fd);
+                throw std::runtime_error("cannot map " + file);
+            }
+            data = static_cast<const char*>(p);
+            madvise(p, length, MADV_SEQUENTIAL);
+        }
+        close(fd);
+    }
+
+    Graph6Stream(const Graph6Stream&) = delete;
+    Graph6Stream& operator=(const Graph6Stream&) = delete;
+
+    ~Graph6Stream()
+    {
+        if(data)
+        {
+            munmap(const_cast<char*>(data), length);
+        }
+    }
+
+    // the next record, false at the end of the file. Records which are not needed are skipped by this without decoding
+    bool nextLine(std::string_view& line)
+    {
+        while(pos < length)
+        {
+            const char* newline = static_cast<const char*>(std::memchr(data + pos, '\n', length - pos));
+            size_t end = newline ? (size_t)(newline - data) : length;
+            line = std::string_view(data + pos, end - pos);
+            pos = end + 1;
+            if(graph6_record(line))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool next(EdgeList& g)
+    {
+        std::string_view line;
+        if(!nextLine(line))
+        {
+            return false;
+        }
+        decode_graph6(line, g);
+        return true;
+    }
+
+  private:
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t pos = 0;
+};
+
+// graph6 records read line by line from a stream that cannot be mapped, such as the output of a generator on stdin
+class Graph6Reader
+{
+  public:
+    explicit Graph6Reader(std::istream& in) : in(in) {}
+
+    // the next record, valid until the next call
+    bool nextLine(std::string_view& line)
+    {
+        while(std::getline(in, buffer))
+        {
+            line = buffer;
+            if(graph6_record(line))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool next(EdgeList& g)
+    {
+        std::string_view line;
+        if(!nextLine(line))
+        {
+            return false;
+        }
+        decode_graph6(line, g);
+        return true;
+    }
+
+  private:
+    std::istream& in;
+    std::string buffer;
+};
+}  // namespace ba_graph
+#endif  // GRAPH6_STREAM_HPP
@@ -2,9 +2,30 @@
 
 #include "sat/solver_cmsat.hpp"
 #include "ecd.hpp"
+#include "ecd_budget.hpp"
+#include "ecd_iterative.hpp"
+#include "ecd_parallel.hpp"
+#include "ecd_portfolio.hpp"
 #include "ecd_sat.hpp"
 #include "io/graph6.hpp"
 #include "util/cxxopts.hpp"
+#include "batch.hpp"
+#include "graph6_stream.hpp"
+#include "ecd_cache.hpp"
+#include "ecd_prefilter.hpp"
+#include "ecd_stats.hpp"
+#include "ecd_verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
 
 // Cycle decomposition, is a partition of E(g) into edge-disjoint cycles.
 // Cycle decomposition is called even, if each cycle of the cycle decomposition
@@ -21,33 +42,798 @@ cxxopts::Options options("ecd",
                          "\nDetermine the sizes of ecd (or -1 if doesn't exist) of graphs from a given file. "
                          "Results are printed to stdout\n");
 bool use_line_graph;
+bool incremental;
 std::string algorithm;
+int search_threads;
+int batch_threads;
+EcdEncoding encoding;
+EcdOrdering ordering;
+EcdCheckpoint checkpoint;  // no file, no checkpoints
+EcdBudget budget;
+std::vector<EcdAttempt> fallback;  // with a budget the engines tried for each graph, otherwise empty
+std::ofstream witness_file;
+long long graph_index = 0;
+
+// records of the input to process, chosen by --range, --shard and --resume
+struct RecordSelection
+{
+    long long begin = 0;
+    long long end = LLONG_MAX;
+    long long shard = 0;
+    long long shards = 1;
+
+    bool contains(long long index) const
+    {
+        return index >= begin && index < end && index % shards == shard;
+    }
+};
+
+RecordSelection selection;
+bool tag_results;  // each result starts with the index of its record
+std::unique_ptr<EcdCache> cache;
+std::array<std::atomic<long long>, (int)EcdFilter::odd_component + 1> filter_hits{};
+bool print_stats;
+
+// every color class on its own line as a list of edges "u v"
+std::string format_witness(const std::vector<Graph>& subgraphs)
+{
+    std::ostringstream out;
+    for(auto& subg : subgraphs)
+    {
+        bool first = true;
+        for(auto& r : subg)
+        {
+            for(auto& i : r)
+            {
+                if(!i.is_primary())
+                {
+                    continue;
+                }
+                out << (first ? "" : " ") << i.n1().to_int() << " " << i.n2().to_int();
+                first = false;
+            }
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+// graphs failing a necessary condition get -1 without any search, the filters that fired are counted
+bool prefiltered(EcdFilter filter)
+{
+    if(filter == EcdFilter::none)
+    {
+        return false;
+    }
+    filter_hits[(int)filter]++;
+    return true;
+}
+
+// size of the ecd of g by the chosen algorithm, with witness_file open the decomposition is stored in witness
+int compute_ecd(const Graph& g, CMSatSolver& solver, Factory& f, std::string& witness)
+{
+    if(prefiltered(ecd_prefilter(g)))
+    {
+        return -1;
+    }
+    if(witness_file.is_open())
+    {
+        // the decomposition comes out of the same search, its size is the result
+        std::vector<Graph> subgraphs;
+        if(algorithm == "backtracking")
+        {
+            subgraphs = ecd_subgraphs(g, search_threads, f, ordering);
+        }
+        else if(algorithm == "sat")
+        {
+            subgraphs = ecd_subgraphs_sat(g, f, encoding);
+        }
+        else
+        {
+            std::cerr << "no witnesses for algorithm: " << algorithm << std::endl;
+            exit(1);
+        }
+        witness = format_witness(subgraphs);
+        return subgraphs.empty() ? (g.size() ? -1 : 0) : (int)subgraphs.size();
+    }
+    if(algorithm == "backtracking")
+    {
+        if(!checkpoint.file.empty())
+        {
+            return ecd_size_checkpointed(g, checkpoint, ordering);
+        }
+        return ecd_size(g, search_threads, ordering);
+    }
+    if(algorithm == "sat")
+    {
+        return incremental ? ecd_size_sat_incremental(g, true, encoding) : ecd_size_sat(solver, g, encoding);
+    }
+    if(algorithm == "portfolio")
+    {
+        return ecd_size_portfolio(g);
+    }
+    std::cerr << "wrong algorithm: " << algorithm << std::endl;
+    exit(1);
+}
+
+// size of the ecd of a graph decoded straight from the mapped file, used when no witnesses are written
+int search_ecd_size(const EdgeList& g, CMSatSolver& solver)
+{
+    if(!fallback.empty())
+    {
+        return ecd_size_fallback(g, fallback, budget);
+    }
+    if(algorithm == "backtracking")
+    {
+        if(!checkpoint.file.empty())
+        {
+            return ecd_size_checkpointed(g, checkpoint, ordering);
+        }
+        return ecd_size(g, search_threads, ordering);
+    }
+    if(algorithm == "sat")
+    {
+        return incremental ? ecd_size_sat_incremental(g, true, encoding) : ecd_size_sat(solver, g, encoding);
+    }
+    if(algorithm == "portfolio")
+    {
+        return ecd_size_portfolio(g);
+    }
+    std::cerr << "wrong algorithm: " << algorithm << std::endl;
+    exit(1);
+}
+
+// the size is looked up in the cache first and stored there when it had to be searched for
+int compute_ecd_size(const EdgeList& g, CMSatSolver& solver)
+{
+    EcdCacheKey key;
+    if(!cache || !ecd_cache_key(g, key))
+    {
+        return search_ecd_size(g, solver);
+    }
+    int res;
+    if(!cache->lookup(key, res))
+    {
+        res = search_ecd_size(g, solver);
+        // the graph may get a larger budget next time
+        if(res != ecd_timeout)
+        {
+            cache->insert(key, res);
+        }
+    }
+    return res;
+}
+
+// runs compute with the counters of the search collected in stats, if they are printed
+template <typename Compute>
+void with_stats(EcdStats& stats, Compute compute)
+{
+    if(!print_stats)
+    {
+        compute();
+        return;
+    }
+    EcdStatsScope scope(stats);
+    compute();
+}
+
+// one line "stats index key=value ...", the sat probes as k:sat|unsat:seconds:conflicts
+void write_stats(long long index, const EcdStats& stats)
+{
+    std::ostringstream out;
+    out << "stats " << index << " nodes=" << stats.nodes << " prune_conflict=" << stats.prune_conflict
+        << " prune_bound=" << stats.prune_bound << " prune_forward=" << stats.prune_forward << " prune_done=" << stats.prune_done << " max_depth=" << stats.max_depth
+        << " bounds_time=" << stats.bounds_time << " search_time=" << stats.search_time << " vars=" << stats.vars
+        << " clauses=" << stats.clauses << " symmetry_vars=" << stats.symmetry_vars
+        << " symmetry_time=" << stats.symmetry_time << " probes=";
+    for(size_t i = 0; i < stats.probes.size(); ++i)
+    {
+        const EcdProbe& p = stats.probes[i];
+        out << (i ? "," : "") << p.k << ":" << (p.satisfiable ? "sat" : "unsat") << ":" << p.time << ":" << p.conflicts;
+    }
+    std::cerr << out.str() << "\n";
+}
+
+// for each graph its index and ecd size, then the color classes
+void write_result(long long index, int res, const std::string& witness, const EcdStats& stats)
+{
+    // the witness is on disk before its result, so a run resumed after a crash finds the witnesses of all the
+    // results it skips
+    if(witness_file.is_open())
+    {
+        witness_file << index << " " << res << "\n" << witness;
+        witness_file.flush();
+    }
+    if(tag_results)
+    {
+        std::cout << index << " ";
+    }
+    if(res == ecd_timeout)
+    {
+        std::cout << "timeout\n";
+    }
+    else
+    {
+        std::cout << res << "\n";
+    }
+    if(print_stats)
+    {
+        write_stats(index, stats);
+    }
+}
+
 CMSatSolver solver;
 
 void process_graph(std::string& file_name, Graph& g, Factory& f, void* param)
 {
     (void)file_name;
     (void)param;
-    (void)f;
 
+    long long index = graph_index++;
+    if(!selection.contains(index))
+    {
+        return;
+    }
+    std::string witness;
+    EcdStats stats;
     int res;
-    Graph lg = line_graph(g);
-    Graph& used_g = (use_line_graph ? lg : g);
-    if(algorithm == "backtracking")
+    with_stats(stats, [&]() {
+        res = use_line_graph ? compute_ecd(line_graph(g), solver, f, witness) : compute_ecd(g, solver, f, witness);
+    });
+    write_result(index, res, witness, stats);
+    std::cout.flush();
+}
+
+// graphs are read and line graphs built on the main thread, workers only run the searches, each with its own
+// solver and factory. Results are written in the order of the input
+struct GraphJob
+{
+    long long index;
+    Graph g;
+    int res = 0;
+    std::string witness;
+    EcdStats stats;
+};
+
+struct BatchState
+{
+    std::vector<CMSatSolver> solvers;
+    std::vector<std::unique_ptr<Factory>> factories;
+    std::unique_ptr<OrderedBatch<GraphJob>> batch;
+
+    explicit BatchState(int threads) : solvers(threads)
     {
-        res = ecd_size(used_g);
+        for(int i = 0; i < threads; ++i)
+        {
+            factories.emplace_back(std::make_unique<Factory>());
+        }
+        batch = std::make_unique<OrderedBatch<GraphJob>>(
+          threads,
+          [this](int id, GraphJob& job) {
+              with_stats(job.stats, [&]() { job.res = compute_ecd(job.g, solvers[id], *factories[id], job.witness); });
+          },
+          [](GraphJob& job) { write_result(job.index, job.res, job.witness, job.stats); });
     }
-    else if(algorithm == "sat")
+};
+
+void submit_graph(std::string& file_name, Graph& g, Factory& f, BatchState* state)
+{
+    (void)file_name;
+    (void)f;
+
+    long long index = graph_index++;
+    if(!selection.contains(index))
+    {
+        return;
+    }
+    if(use_line_graph)
     {
-        res = ecd_size_sat(solver, used_g);
+        state->batch->submit({index, line_graph(g)});
     }
     else
     {
-        std::cerr << "wrong algorithm: " << algorithm << std::endl;
+        state->batch->submit({index, std::move(g)});
+    }
+}
+
+struct EdgeListJob
+{
+    long long index;
+    EdgeList g;
+    int res = 0;
+    bool decided = false;  // by the prefilter, no search is needed
+    EcdStats stats;
+};
+
+EdgeListJob prefilter_job(long long index, EdgeList g)
+{
+    EdgeListJob job{index, std::move(g)};
+    if(prefiltered(ecd_prefilter(job.g)))
+    {
+        job.res = -1;
+        job.decided = true;
+    }
+    return job;
+}
+
+void solve_job(CMSatSolver& solver, EdgeListJob& job)
+{
+    if(!job.decided)
+    {
+        with_stats(job.stats, [&]() { job.res = compute_ecd_size(job.g, solver); });
+    }
+}
+
+// the selected records of reader one by one, the others are skipped without decoding. f gets the index of the
+// record and the graph to solve, the line graph with -l, in buffers reused for the next record
+template <typename Reader, typename F>
+void for_selected(Reader& reader, F f)
+{
+    std::string_view line;
+    EdgeList g, lg;
+    for(long long index = 0; index < selection.end && reader.nextLine(line); ++index)
+    {
+        if(!selection.contains(index))
+        {
+            continue;
+        }
+        decode_graph6(line, g);
+        if(use_line_graph)
+        {
+            line_graph(g, lg);
+            f(index, lg);
+        }
+        else
+        {
+            f(index, g);
+        }
+    }
+}
+
+// graphs from stdin go through the stages parse -> prefilter -> solve -> write. Each stage has a bounded queue
+// in front of it, so a generator piped in is stalled when the solvers fall behind and the memory stays constant
+void pipeline_graphs(std::istream& in)
+{
+    int threads = std::max(batch_threads, 1);
+    BoundedQueue<std::pair<long long, EdgeList>> parsed(4 * threads);
+    // a malformed record ends the input, the graphs before it are still solved and written, then the error is
+    // reported on the main thread. If the solving fails, parsed is closed and the parser stops at the next push
+    struct Abandoned
+    {
+    };
+    std::exception_ptr parse_error;
+    std::thread parser([&]() {
+        try
+        {
+            Graph6Reader reader(in);
+            for_selected(reader, [&](long long index, const EdgeList& g) {
+                if(!parsed.push({index, g}))
+                {
+                    throw Abandoned();
+                }
+            });
+        }
+        catch(const Abandoned&)
+        {
+        }
+        catch(...)
+        {
+            parse_error = std::current_exception();
+        }
+        parsed.close();
+    });
+
+    std::vector<CMSatSolver> solvers(threads);
+    OrderedBatch<EdgeListJob> batch(
+      threads,
+      [&solvers](int id, EdgeListJob& job) { solve_job(solvers[id], job); },
+      [](EdgeListJob& job) {
+          write_result(job.index, job.res, "", job.stats);
+          std::cout.flush();
+      });
+    try
+    {
+        std::pair<long long, EdgeList> record;
+        while(parsed.pop(record))
+        {
+            batch.submit(prefilter_job(record.first, std::move(record.second)));
+        }
+        batch.finish();
+    }
+    catch(...)
+    {
+        parsed.close();
+        parser.join();
+        throw;
+    }
+    parser.join();
+    if(parse_error)
+    {
+        std::rethrow_exception(parse_error);
+    }
+}
+
+// graphs are decoded one by one into the same buffers, the batch jobs get their own copies
+void stream_graphs(const std::string& file)
+{
+    Graph6Stream stream(file);
+    if(batch_threads > 1)
+    {
+        std::vector<CMSatSolver> solvers(batch_threads);
+        OrderedBatch<EdgeListJob> batch(
+          batch_threads, [&solvers](int id, EdgeListJob& job) { solve_job(solvers[id], job); },
+          [](EdgeListJob& job) { write_result(job.index, job.res, "", job.stats); });
+        for_selected(stream, [&](long long index, const EdgeList& g) { batch.submit(prefilter_job(index, g)); });
+        batch.finish();
+        return;
+    }
+    // solved in the buffers, no job is needed
+    for_selected(stream, [](long long index, const EdgeList& g) {
+        int res = -1;
+        EcdStats stats;
+        if(!prefiltered(ecd_prefilter(g)))
+        {
+            with_stats(stats, [&]() { res = compute_ecd_size(g, solver); });
+        }
+        write_result(index, res, "", stats);
+        std::cout.flush();
+    });
+}
+
+AmoEncoding parse_encoding(const std::string& name)
+{
+    if(name == "pairwise")
+    {
+        return AmoEncoding::pairwise;
+    }
+    if(name == "sequential")
+    {
+        return AmoEncoding::sequential;
+    }
+    if(name == "commander")
+    {
+        return AmoEncoding::commander;
+    }
+    if(name == "ladder")
+    {
+        return AmoEncoding::ladder;
+    }
+    std::cerr << "wrong encoding: " << name << std::endl;
+    exit(1);
+}
+
+EcdOrder parse_order(const std::string& name)
+{
+    if(name == "numeric")
+    {
+        return EcdOrder::numeric;
+    }
+    if(name == "bfs")
+    {
+        return EcdOrder::bfs;
+    }
+    if(name == "constrained")
+    {
+        return EcdOrder::constrained;
+    }
+    if(name == "degree")
+    {
+        return EcdOrder::degree;
+    }
+    if(name == "random")
+    {
+        return EcdOrder::random;
+    }
+    std::cerr << "wrong order: " << name << std::endl;
+    exit(1);
+}
+
+SymmetryBreaking parse_symmetry(const std::string& name)
+{
+    if(name == "graph")
+    {
+        return SymmetryBreaking::graph;
+    }
+    if(name == "breakid")
+    {
+        return SymmetryBreaking::breakid;
+    }
+    if(name == "none")
+    {
+        return SymmetryBreaking::none;
+    }
+    std::cerr << "wrong symmetry breaking: " << name << std::endl;
+    exit(1);
+}
+
+// parts of the name separated by sep
+std::vector<std::string> split(const std::string& s, char sep)
+{
+    std::vector<std::string> parts;
+    std::istringstream in(s);
+    for(std::string part; std::getline(in, part, sep);)
+    {
+        parts.push_back(part);
+    }
+    return parts;
+}
+
+// backtracking[:order[:seed]] or sat[:encoding[:symmetry[:two]]], as the configurations of the bench
+EcdAttempt parse_attempt(const std::string& name)
+{
+    EcdAttempt attempt;
+    std::vector<std::string> parts = split(name, ':');
+    if(!parts.empty() && parts[0] == "backtracking" && parts.size() <= 3)
+    {
+        if(parts.size() > 1)
+        {
+            attempt.ordering.order = parse_order(parts[1]);
+        }
+        if(parts.size() > 2)
+        {
+            attempt.ordering.seed = (uint32_t)std::stoul(parts[2]);
+        }
+        return attempt;
+    }
+    if(!parts.empty() && parts[0] == "sat" && parts.size() <= 4)
+    {
+        attempt.engine = EcdEngine::sat;
+        if(parts.size() > 1)
+        {
+            attempt.encoding.at_most_one = parse_encoding(parts[1]);
+        }
+        if(parts.size() > 2)
+        {
+            attempt.encoding.symmetry = parse_symmetry(parts[2]);
+        }
+        if(parts.size() > 3)
+        {
+            attempt.encoding.exactly_two = parts[3] == "two";
+        }
+        return attempt;
+    }
+    std::cerr << "wrong engine: " << name << std::endl;
+    exit(1);
+}
+
+// i/n with 0 <= i < n, the records whose index modulo n is i
+void parse_shard(const std::string& name, RecordSelection& selection)
+{
+    std::vector<std::string> parts = split(name, '/');
+    try
+    {
+        if(parts.size() == 2)
+        {
+            selection.shard = std::stoll(parts[0]);
+            selection.shards = std::stoll(parts[1]);
+            if(selection.shard >= 0 && selection.shard < selection.shards)
+            {
+                return;
+            }
+        }
+    }
+    catch(const std::logic_error&)
+    {
+    }
+    std::cerr << "wrong shard: " << name << std::endl;
+    exit(1);
+}
+
+// start:end, the records start..end-1, without end up to the end of the input
+void parse_range(const std::string& name, RecordSelection& selection)
+{
+    std::vector<std::string> parts = split(name, ':');
+    try
+    {
+        if(parts.size() == 1 || parts.size() == 2)
+        {
+            selection.begin = std::stoll(parts[0]);
+            selection.end = parts.size() == 2 && !parts[1].empty() ? std::stoll(parts[1]) : LLONG_MAX;
+            if(selection.begin >= 0 && selection.begin <= selection.end)
+            {
+                return;
+            }
+        }
+    }
+    catch(const std::logic_error&)
+    {
+    }
+    std::cerr << "wrong range: " << name << std::endl;
+    exit(1);
+}
+
+// index of the last complete result "index size" in the output of an earlier run, -1 if there is none (or no file
+// yet). The results are written in the order of the records, so all the selected ones before it are done as well.
+// A line cut off by a crash has no newline, it is removed so that the new results can be appended. Output without
+// the indices (of a run without --resume, --range and --shard) cannot be resumed
+long long last_result(const std::string& file)
+{
+    std::ifstream in(file);
+    long long last = -1;
+    std::streamoff complete = 0;
+    bool untagged = false;
+    std::string line;
+    while(std::getline(in, line) && !in.eof())
+    {
+        complete = in.tellg();
+        long long index;
+        std::string res;
+        if(std::istringstream(line) >> index >> res)
+        {
+            last = std::max(last, index);
+        }
+        else if(!line.empty())
+        {
+            untagged = true;
+        }
+    }
+    if(untagged && last == -1)
+    {
+        std::cerr << "results in " << file << " have no record indices, the run which wrote them needs --resume, "
+                  << "--range or --shard" << std::endl;
         exit(1);
     }
+    if(in.eof() && !line.empty())
+    {
+        in.close();
+        std::filesystem::resize_file(file, complete);
+    }
+    return last;
+}
+
+// the witnesses written by --witness-file are checked against the graphs of the input file with the same index
+struct WitnessCheck
+{
+    std::ifstream in;
+    int invalid = 0;         // also the missing and unmatched certificates
+    bool malformed = false;  // the rest of the file cannot be matched to the records
+    // the next certificate, read ahead until the record of its index comes
+    bool read = false;
+    long long index = -1;
+    int size = 0;
+    std::vector<std::vector<std::pair<int, int>>> classes;
+};
+
+// the certificate of the next graph, its lines "u v u v ..." are the color classes. False if it is malformed
+bool read_certificate(std::istream& in, long long& index, int& size, std::vector<std::vector<std::pair<int, int>>>& classes)
+{
+    std::string line;
+    if(!std::getline(in, line) || !(std::istringstream(line) >> index >> size))
+    {
+        return false;
+    }
+    classes.assign(std::max(size, 0), {});
+    for(auto& cls : classes)
+    {
+        if(!std::getline(in, line))
+        {
+            return false;
+        }
+        std::istringstream edges(line);
+        for(int u, v; edges >> u >> v;)
+        {
+            cls.emplace_back(u, v);
+        }
+    }
+    return true;
+}
+
+// drop the witnesses after the result of index last and a witness cut off by a crash, a resumed run appends the
+// witnesses of the records after last
+void truncate_witnesses(const std::string& file, long long last)
+{
+    std::ifstream in(file);
+    if(!in)
+    {
+        return;
+    }
+    std::streamoff kept = 0;
+    long long index;
+    int size;
+    std::vector<std::vector<std::pair<int, int>>> classes;
+    while(read_certificate(in, index, size, classes) && index <= last && !in.eof())
+    {
+        kept = in.tellg();
+    }
+    in.close();
+    std::filesystem::resize_file(file, kept);
+}
+
+// reads ahead the next certificate, false if there is none. A malformed one is reported as invalid for record
+bool next_certificate(WitnessCheck* check, long long record)
+{
+    if(check->read || check->malformed)
+    {
+        return check->read;
+    }
+    check->in >> std::ws;
+    if(check->in.peek() == EOF)
+    {
+        return false;
+    }
+    check->read = read_certificate(check->in, check->index, check->size, check->classes);
+    if(!check->read)
+    {
+        check->malformed = true;
+        check->invalid++;
+        std::cout << record << " invalid\n";
+    }
+    return check->read;
+}
+
+// a certificate which matches no selected record: a duplicate, out of order or past the last record
+void unmatched_certificate(WitnessCheck* check)
+{
+    check->read = false;
+    check->invalid++;
+    std::cout << check->index << " invalid\n";
+}
+
+// prints for each selected graph its index and valid, invalid, none (no ecd was claimed, so there is nothing to
+// check) or missing (there is no certificate of it)
+void verify_graph(std::string& file_name, Graph& g, Factory& f, WitnessCheck* check)
+{
+    (void)file_name;
+    (void)f;
+
+    long long record = graph_index++;
+    // certificates come in the order of the records, the ones of records which are not selected are skipped
+    while(next_certificate(check, record) && check->index <= record)
+    {
+        if(!selection.contains(check->index))
+        {
+            check->read = false;
+        }
+        else if(check->index < record)
+        {
+            unmatched_certificate(check);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if(check->malformed || !selection.contains(record))
+    {
+        return;
+    }
+    if(!check->read || check->index > record)
+    {
+        check->invalid++;
+        std::cout << record << " missing\n";
+        return;
+    }
+    check->read = false;
 
-    std::cout << res << std::endl;
+    // vertices keep their numbers, as in the witness file
+    auto numbered = [](const Graph& h) {
+        EdgeList list;
+        for(auto& r : h)
+        {
+            list.n = std::max(list.n, r.n().to_int() + 1);
+            for(auto& i : r)
+            {
+                if(i.is_primary())
+                {
+                    list.edges.emplace_back(i.n1().to_int(), i.n2().to_int());
+                }
+            }
+        }
+        return list;
+    };
+    EdgeList list = use_line_graph ? numbered(line_graph(g)) : numbered(g);
+
+    const char* verdict = "valid";
+    if(check->size == -1)
+    {
+        verdict = "none";
+    }
+    else if(check->size == 0 ? list.size() != 0 : !is_ecd_certificate(list, check->classes))
+    {
+        verdict = "invalid";
+    }
+    check->invalid += verdict[0] == 'i';
+    std::cout << record << " " << verdict << "\n";
 }
 
 void wrong_usage()
@@ -59,9 +845,30 @@ int main(int argc, char** argv)
 {
     try
     {
-        options.add_options()("h, help", "print help")("i,input-graph-file", "graph file to the ecd of", cxxopts::value<std::string>())(
+        options.add_options()("h, help", "print help")("i,input-graph-file", "graph file to the ecd of, - reads graph6 from stdin", cxxopts::value<std::string>())(
           "l,linegraph", "whether to the ecd of the line graph", cxxopts::value<bool>()->default_value("false"))(
-          "a, algorithm-used", "which algorithm to use to find ecd (backtracking/sat)", cxxopts::value<std::string>()->default_value("sat"));
+          "a, algorithm-used", "which algorithm to use to find ecd (backtracking/sat/portfolio)", cxxopts::value<std::string>()->default_value("sat"))(
+          "j,search-threads", "number of threads the backtracking uses for a single graph", cxxopts::value<int>()->default_value("1"))(
+          "threads", "number of graphs processed in parallel", cxxopts::value<int>()->default_value("1"))(
+          "incremental", "keep one solver for all steps of the sat binary search", cxxopts::value<bool>()->default_value("false"))(
+          "encoding", "at most one encoding of the sat (pairwise/sequential/commander/ladder)", cxxopts::value<std::string>()->default_value("pairwise"))(
+          "exactly-two", "add to the sat that each vertex has 0 or 2 edges of every color", cxxopts::value<bool>()->default_value("false"))(
+          "symmetry", "symmetry breaking of the sat (graph/breakid/none)", cxxopts::value<std::string>()->default_value("graph"))(
+          "order", "order of the edges starting the cycles of the backtracking (numeric/bfs/constrained/degree/random)", cxxopts::value<std::string>()->default_value("numeric"))(
+          "seed", "seed of the random order, restarts use the following ones", cxxopts::value<uint32_t>()->default_value("0"))(
+          "checkpoint", "save the state of the backtracking to this file and resume from it when run again", cxxopts::value<std::string>())(
+          "checkpoint-interval", "seconds between two saves of the checkpoint", cxxopts::value<double>()->default_value("60"))(
+          "time-limit", "seconds each engine of the fallback may search a graph, 0 is no limit", cxxopts::value<double>()->default_value("0"))(
+          "node-limit", "nodes (conflicts of the sat) each engine of the fallback may search a block, 0 is no limit", cxxopts::value<long long>()->default_value("0"))(
+          "fallback", "engines tried one after another when the previous one runs out of the limits, e.g. backtracking,sat:pairwise:breakid,sat:pairwise:none", cxxopts::value<std::string>())(
+          "range", "process only the records start..end-1 of the input, as start:end, end may be left out", cxxopts::value<std::string>())(
+          "shard", "process only the records whose index modulo n is i, as i/n", cxxopts::value<std::string>())(
+          "resume", "continue after the last result in this output of an earlier run, the new results are to be appended to it. The earlier run has to write the record indices, so it needs --resume (of a new file), --range or --shard too", cxxopts::value<std::string>())(
+          "w,witness-file", "write the found ecds to this file", cxxopts::value<std::string>())(
+          "cache", "file with the ecd sizes of graphs solved before, new ones are appended", cxxopts::value<std::string>())(
+          "verify", "check the witnesses in this file (written by --witness-file) against the input graphs, every record selected by --range and --shard needs one", cxxopts::value<std::string>())(
+          "prefilter-stats", "print to stderr how many graphs each prefilter rejected", cxxopts::value<bool>()->default_value("false"))(
+          "stats", "print to stderr the search counters and sat probes of every graph", cxxopts::value<bool>()->default_value("false"));
 
         options.parse_positional({"i"});
         options.positional_help("<input graph file>");
@@ -86,11 +893,147 @@ int main(int argc, char** argv)
 
         algorithm = result["a"].as<std::string>();
         use_line_graph = result["l"].as<bool>();
-        read_graph6_file<void>(file, process_graph, nullptr);
+        search_threads = result["j"].as<int>();
+        incremental = result["incremental"].as<bool>();
+        encoding.at_most_one = parse_encoding(result["encoding"].as<std::string>());
+        encoding.exactly_two = result["exactly-two"].as<bool>();
+        encoding.symmetry = parse_symmetry(result["symmetry"].as<std::string>());
+        ordering.order = parse_order(result["order"].as<std::string>());
+        ordering.seed = result["seed"].as<uint32_t>();
+        if(result.count("cache"))
+        {
+            cache = std::make_unique<EcdCache>(result["cache"].as<std::string>());
+        }
+        batch_threads = result["threads"].as<int>();
+        print_stats = result["stats"].as<bool>();
+        if(result.count("range"))
+        {
+            parse_range(result["range"].as<std::string>(), selection);
+        }
+        if(result.count("shard"))
+        {
+            parse_shard(result["shard"].as<std::string>(), selection);
+        }
+        long long resumed_after = -1;
+        if(result.count("resume"))
+        {
+            resumed_after = last_result(result["resume"].as<std::string>());
+            selection.begin = std::max(selection.begin, resumed_after + 1);
+        }
+        if(result.count("w"))
+        {
+            // a resumed run keeps the witnesses of the results it skips
+            std::string witnesses = result["w"].as<std::string>();
+            if(result.count("resume"))
+            {
+                truncate_witnesses(witnesses, resumed_after);
+            }
+            witness_file.open(witnesses, result.count("resume") ? std::ios::app : std::ios::out);
+            if(!witness_file)
+            {
+                std::cerr << "cannot open witness file " << witnesses << std::endl;
+                exit(1);
+            }
+        }
+        // the results of a part of the input are told apart by the indices of their records
+        tag_results = result.count("range") || result.count("shard") || result.count("resume");
+        budget.seconds = result["time-limit"].as<double>();
+        budget.nodes = result["node-limit"].as<long long>();
+        if(budget.limited() || result.count("fallback"))
+        {
+            if(search_threads != 1 || result.count("w") || result.count("checkpoint"))
+            {
+                std::cerr << "limits need one search thread, no witnesses and no checkpoint" << std::endl;
+                exit(1);
+            }
+            if(result.count("fallback"))
+            {
+                for(auto& name : split(result["fallback"].as<std::string>(), ','))
+                {
+                    fallback.push_back(parse_attempt(name));
+                }
+            }
+            else if(algorithm == "backtracking")
+            {
+                fallback.push_back({EcdEngine::backtracking, ordering, encoding});
+            }
+            else if(algorithm == "sat")
+            {
+                fallback.push_back({EcdEngine::sat, ordering, encoding});
+            }
+            else
+            {
+                std::cerr << "limits need the backtracking or the sat" << std::endl;
+                exit(1);
+            }
+        }
+        if(result.count("checkpoint"))
+        {
+            if(algorithm != "backtracking" || search_threads != 1 || batch_threads != 1 || result.count("w"))
+            {
+                std::cerr << "checkpoints need the backtracking with one thread and no witnesses" << std::endl;
+                exit(1);
+            }
+            checkpoint.file = result["checkpoint"].as<std::string>();
+            checkpoint.interval = result["checkpoint-interval"].as<double>();
+        }
+        if(result.count("verify"))
+        {
+            WitnessCheck check;
+            check.in.open(result["verify"].as<std::string>());
+            if(!check.in)
+            {
+                std::cerr << "cannot open witness file " << result["verify"].as<std::string>() << std::endl;
+                exit(1);
+            }
+            read_graph6_file<WitnessCheck>(file, verify_graph, &check);
+            while(next_certificate(&check, graph_index))
+            {
+                unmatched_certificate(&check);
+            }
+            std::cout.flush();
+            exit(check.invalid ? 1 : 0);
+        }
+        if(file == "-")
+        {
+            if(witness_file.is_open())
+            {
+                std::cerr << "witnesses need an input file, not stdin" << std::endl;
+                exit(1);
+            }
+            pipeline_graphs(std::cin);
+        }
+        else if(!witness_file.is_open())
+        {
+            stream_graphs(file);
+        }
+        else if(batch_threads > 1)
+        {
+            BatchState state(batch_threads);
+            read_graph6_file<BatchState>(file, submit_graph, &state);
+            state.batch->finish();
+        }
+        else
+        {
+            read_graph6_file<void>(file, process_graph, nullptr);
+        }
+        std::cout.flush();
+        if(result["prefilter-stats"].as<bool>())
+        {
+            for(int i = 1; i < (int)filter_hits.size(); ++i)
+            {
+                std::cerr << ecd_filter_name((EcdFilter)i) << " " << filter_hits[i] << std::endl;
+            }
+        }
     }
     catch(const cxxopts::exceptions::exception& e)
     {
         std::cerr << "error parsing option:" << e.what() << std::endl;
         exit(1);
     }
+    catch(const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef PREPROCESS_BREAKID_HPP
 #define PREPROCESS_BREAKID_HPP
 
+#include "flat_cnf.hpp"
+
 // https://github.com/meelgroup/breakid
 #include <breakid/breakid.hpp>
 
@@ -21,7 +23,8 @@ struct Config
 
 }  // namespace internal
 // according to https://github.com/meelgroup/breakid/blob/master/src/breakid-main.cpp
-inline CNF preprocess_breakid(CNF cnf)
+// the symmetry breaking clauses and auxiliary variables are appended to cnf
+inline void preprocess_breakid(FlatCNF& cnf)
 {
     internal::Config conf;
     BID::BreakID breakid;
@@ -33,30 +36,19 @@ inline CNF preprocess_breakid(CNF cnf)
     breakid.set_verbosity(0);
     breakid.set_steps_lim(conf.steps_lim);
 
-    int nVars = cnf.first;
-    std::vector<std::vector<BID::BLit>> cnf_clauses;
-    cnf_clauses.reserve(cnf.second.size());
+    breakid.start_dynamic_cnf(cnf.vars);
     std::vector<BID::BLit> cnf_inclause;
-
-    for(auto& cnf_cl : cnf.second)
+    size_t clauses = cnf.size();
+    for(size_t i = 0; i < clauses; ++i)
     {
-        for(auto& cnf_lit : cnf_cl)
+        for(const uint32_t* l = cnf.begin(i); l != cnf.end(i); ++l)
         {
-#ifdef BA_GRAPH_DEBUG
-            assert(cnf_lit.var() >= 0);
-#endif
-            cnf_inclause.push_back(BID::BLit(cnf_lit.var(), cnf_lit.neg()));
+            cnf_inclause.push_back(BID::BLit(FlatCNF::var(*l), FlatCNF::neg(*l)));
         }
-        cnf_clauses.push_back(cnf_inclause);
+        breakid.add_clause(cnf_inclause.data(), cnf_inclause.size());
         cnf_inclause.clear();
     }
 
-    breakid.start_dynamic_cnf(nVars);
-    for(auto cnf_cl : cnf_clauses)
-    {
-        breakid.add_clause(cnf_cl.data(), cnf_cl.size());
-    }
-
     breakid.end_dynamic_cnf();
     breakid.detect_subgroups();
     breakid.break_symm();
@@ -65,24 +57,35 @@ inline CNF preprocess_breakid(CNF cnf)
     assert(breakid.get_num_aux_vars() <= INT_MAX);
 #endif
 
-    cnf.first += (int)breakid.get_num_aux_vars();
-    auto brk_clauses = breakid.get_brk_cls();
-    cnf.second.reserve(cnf.second.size() + brk_clauses.size());
-    for(auto& brk_cl : brk_clauses)
+    cnf.vars += (int)breakid.get_num_aux_vars();
+    for(auto& brk_cl : breakid.get_brk_cls())
     {
-        std::vector<Lit> brk_inclause;
         for(auto brk_lit : brk_cl)
         {
 #ifdef BA_GRAPH_DEBUG
             assert(brk_lit.var() <= INT_MAX);
 #endif
-            brk_inclause.push_back(Lit((int)brk_lit.var(), brk_lit.sign()));
+            cnf.push((int)brk_lit.var(), brk_lit.sign());
+        }
+        cnf.close();
+    }
+}
+
+inline CNF preprocess_breakid(CNF cnf)
+{
+#ifdef BA_GRAPH_DEBUG
+    for(auto& cnf_cl : cnf.second)
+    {
+        for(auto& cnf_lit : cnf_cl)
+        {
+            assert(cnf_lit.var() >= 0);
         }
-        cnf.second.push_back(brk_inclause);
-        brk_inclause.clear();
     }
+#endif
+    FlatCNF flat(cnf);
+    preprocess_breakid(flat);
 
-    return cnf;
+    return flat.toCNF();
 }
 }  // namespace ba_graph
 #endif  // PREPROCESS_BREAKID_HPP
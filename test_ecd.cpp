@@ -2,7 +2,14 @@
 #include "sat/solver_cmsat.hpp"
 #include "algorithms/isomorphism/isomorphism.hpp"
 #include "ecd.hpp"
+#include "ecd_budget.hpp"
+#include "ecd_parallel.hpp"
+#include "ecd_portfolio.hpp"
 #include "ecd_sat.hpp"
+#include "graph6_stream.hpp"
+#include "ecd_cache.hpp"
+#include "ecd_iterative.hpp"
+#include "ecd_prefilter.hpp"
 #include "graphs.hpp"
 #include "invariants/colouring.hpp"
 #include "invariants/connectivity.hpp"
@@ -12,6 +19,11 @@
 #include "operations/line_graph.hpp"
 #include "graphs/snarks.hpp"
 
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -27,34 +39,64 @@ enum TestType
 };
 void test_ecd(const Graph &g, int size, TestType type = Equal)
 {
-#ifdef BACKTR
-    if(test_equality)
+    EcdBounds bounds = ecd_bounds(g);
+    if(type == Equal)
     {
-        assert(ecd_size(g) == size);
+        assert(size == -1 ? !bounds.witnessed : bounds.lower <= size && size <= bounds.upper);
     }
-    else
+
+#ifdef BACKTR
+    int res = ecd_size(g);
+    switch(type)
     {
-        assert(ecd_size(g) != size);
+        case Equal:
+            assert(res == size);
+            break;
+        case Nequal:
+            assert(res != size);
+            break;
+        case Leq:
+            assert(res <= size);
+            break;
     }
+    assert(ecd_size(g, 4) == res);
+    assert(ecd_size_iterative(g) == res);
+    assert(has_ecd(g) == (res != -1));
+    assert(res == -1 || (has_ecd_at_most(g, res) && !has_ecd_at_most(g, res - 1)));
 
     Factory f;
     std::vector<Graph> subg = ecd_subgraphs(g, f);
-    assert(is_ecd(g, subg));
+    assert(subg.empty() || is_ecd(g, subg));
 
 #endif
 #ifdef SAT
+    int res = ecd_size_sat(solver, g);
     switch(type)
     {
         case Equal:
-            assert(ecd_size_sat(solver, g) == size);
+            assert(res == size);
             break;
         case Nequal:
-            assert(ecd_size_sat(solver, g) != size);
+            assert(res != size);
             break;
         case Leq:
-            assert(ecd_size_sat(solver, g) <= size);
+            assert(res <= size);
             break;
     }
+    for(auto amo : {AmoEncoding::sequential, AmoEncoding::commander, AmoEncoding::ladder})
+    {
+        EcdEncoding encoding{amo, amo == AmoEncoding::sequential};
+        assert(res == -1 || (has_ecd_size_sat(solver, g, res, false, encoding) && !has_ecd_size_sat(solver, g, res - 1, false, encoding)));
+    }
+    assert(ecd_size_sat(solver, g, {AmoEncoding::pairwise, false, SymmetryBreaking::breakid}) == res);
+#ifdef COMPILE_WITH_CRYPTOMINISAT
+    assert(ecd_size_sat_incremental(g) == res);
+    assert(ecd_size_portfolio(g) == res);
+
+    Factory f;
+    std::vector<Graph> subg = ecd_subgraphs_sat(g, f);
+    assert(res <= 0 ? subg.empty() : (int)subg.size() == res && is_ecd(g, subg));
+#endif
 #endif
 }
 
@@ -116,6 +158,26 @@ int main()
     subg[0] = circuit(1);
     assert(!is_ecd(g, subg));
 
+    // vertices numbered otherwise in the subgraph are still the vertices of g
+    g = circuit(4);
+    subg.clear();
+    subg.emplace_back(createG());
+    for(auto& r : g)
+    {
+        addV(subg[0], r.v(), r.n().to_int() + 10);
+    }
+    for(auto& r : g)
+    {
+        for(auto& i : r)
+        {
+            if(i.is_primary())
+            {
+                addE(subg[0], i.e());
+            }
+        }
+    }
+    assert(is_ecd(g, subg));
+
     g = empty_graph(0);
     test_ecd(g, 0);
 
@@ -425,4 +487,348 @@ int main()
             }
         }
     }
-}
\ No newline at end of file
+
+    // graphs decoded by the mapped reader give the same results as the ones read into a Graph
+    {
+        std::string file = "graphs/3regular/chromatic_index_3/08_3_3_chi3.g6";
+        auto graphs = read_graph6_file(file).graphs();
+        Graph6Stream stream(file);
+        EdgeList e, le;
+        size_t i = 0;
+        for(; stream.next(e); ++i)
+        {
+            assert(i < graphs.size() && e.order() == graphs[i].order() && e.size() == graphs[i].size());
+            line_graph(e, le);
+            assert(le.order() == e.size());
+#ifdef BACKTR
+            assert(ecd_size(le) == ecd_size(line_graph(graphs[i])));
+            assert(ecd_size(e) == ecd_size(graphs[i]));
+#endif
+#ifdef SAT
+            assert(ecd_size_sat(solver, le) == ecd_size_sat(solver, line_graph(graphs[i])));
+#endif
+        }
+        assert(i == graphs.size());
+    }
+
+    // the cache keys do not depend on the labelling and tell the non-isomorphic graphs of a file apart
+    {
+        Graph6Stream stream("graphs/4regular/09_4_3.g6");
+        std::mt19937 rng(7);
+        std::set<std::pair<uint64_t, uint32_t>> keys;
+        std::vector<EcdCacheKey> all;
+        EdgeList e;
+        while(stream.next(e))
+        {
+            EcdCacheKey key, relabelled_key;
+            assert(ecd_cache_key(e, key));
+            std::vector<int> p(e.n);
+            std::iota(p.begin(), p.end(), 0);
+            std::shuffle(p.begin(), p.end(), rng);
+            EdgeList relabelled{e.n, {}};
+            for(auto [u, v] : e.edges)
+            {
+                relabelled.edges.emplace_back(p[v], p[u]);
+            }
+            std::shuffle(relabelled.edges.begin(), relabelled.edges.end(), rng);
+            assert(ecd_cache_key(relabelled, relabelled_key));
+            assert(key.hash == relabelled_key.hash && key.check == relabelled_key.check);
+            assert(keys.insert({key.hash, key.check}).second);
+            all.push_back(key);
+        }
+
+        std::string file = "test_ecd_cache.tmp";
+        std::remove(file.c_str());
+        {
+            EcdCache cache(file);
+            for(size_t i = 0; i < all.size(); ++i)
+            {
+                cache.insert(all[i], (int)i);
+            }
+        }
+        EcdCache cache(file);
+        for(size_t i = 0; i < all.size(); ++i)
+        {
+            int size;
+            assert(cache.lookup(all[i], size) && size == (int)i);
+        }
+
+        // a record cut off at the end is dropped, so the ones appended after it stay in place
+        {
+            std::ofstream out(file, std::ios::binary | std::ios::app);
+            out.write("partial", 7);
+        }
+        {
+            EcdCache cut(file);
+            cut.insert(EcdCacheKey{1, 2}, 3);
+        }
+        {
+            EcdCache cut(file);
+            int size;
+            assert(cut.lookup(all[0], size) && size == 0);
+            assert(cut.lookup(EcdCacheKey{1, 2}, size) && size == 3);
+        }
+        std::remove(file.c_str());
+
+        // two headers, the records after them would be shifted
+        {
+            std::ofstream out(file, std::ios::binary);
+            out.write("ECDCACH1ECDCACH1", 16);
+        }
+        bool rejected = false;
+        try
+        {
+            EcdCache doubled(file);
+        }
+        catch(const std::runtime_error&)
+        {
+            rejected = true;
+        }
+        assert(rejected);
+        std::remove(file.c_str());
+    }
+
+    // each filter on a graph failing only its own condition
+    assert(ecd_prefilter(EdgeList{3, {{0, 1}, {1, 2}, {2, 0}}}) == EcdFilter::odd_size);
+    assert(ecd_prefilter(EdgeList{3, {{0, 0}, {1, 2}, {2, 1}, {1, 2}}}) == EcdFilter::loop);
+    assert(ecd_prefilter(EdgeList{3, {{0, 1}, {1, 2}}}) == EcdFilter::odd_degree);
+    assert(ecd_prefilter(EdgeList{6, {{0, 1}, {1, 2}, {2, 0}, {3, 4}, {4, 5}, {5, 3}}}) == EcdFilter::odd_component);
+    assert(ecd_prefilter(EdgeList{4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}}}) == EcdFilter::none);
+    assert(ecd_prefilter(create_petersen()) == EcdFilter::odd_size);
+    assert(ecd_prefilter(line_graph(create_petersen())) == EcdFilter::none);
+    assert(ecd_size(EdgeList{6, {{0, 1}, {1, 2}, {2, 0}, {3, 4}, {4, 5}, {5, 3}}}) == -1);
+
+    // graphs glued at a vertex and disjoint unions are solved block by block, the whole graph gives the same size
+    {
+        std::vector<EdgeList> parts;
+        Graph6Stream stream("graphs/4regular/07_4_3.g6");
+        for(EdgeList e; stream.next(e);)
+        {
+            parts.push_back(e);
+        }
+        parts.push_back(EdgeList{3, {{0, 1}, {1, 2}, {2, 0}}});
+        parts.push_back(EdgeList{4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}}});
+        for(auto& a : parts)
+        {
+            for(auto& b : parts)
+            {
+                EdgeList glued = a, disjoint = a;
+                glued.n = a.n + b.n - 1;
+                disjoint.n = a.n + b.n;
+                for(auto [u, v] : b.edges)
+                {
+                    glued.edges.emplace_back(u == 0 ? 0 : u + a.n - 1, v == 0 ? 0 : v + a.n - 1);
+                    disjoint.edges.emplace_back(u + a.n, v + a.n);
+                }
+                assert(internal::ecd_blocks(glued).size() >= 2 && internal::ecd_blocks(disjoint).size() >= 2);
+                for(auto& g : {glued, disjoint})
+                {
+                    internal::Ecd whole(g);
+                    assert(ecd_size(g) == whole.getSize());
+#ifdef SAT
+                    assert(ecd_size_sat(solver, g) == whole.getSize());
+#endif
+                }
+            }
+        }
+    }
+
+    // certificates given by the ends of the edges
+    {
+        EdgeList bowtie{7, {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 4}, {4, 5}, {5, 6}, {6, 0}}};
+        assert(is_ecd_certificate(bowtie, {{{0, 1}, {2, 1}, {2, 3}, {0, 3}}, {{4, 0}, {4, 5}, {5, 6}, {6, 0}}}));
+        assert(!is_ecd_certificate(bowtie, {{{0, 1}, {1, 2}, {2, 3}, {3, 0}}, {{0, 4}, {4, 5}, {5, 6}, {6, 0}}, {}}));
+        assert(!is_ecd_certificate(bowtie, {{{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 4}, {4, 5}, {5, 6}, {6, 0}}}));
+        assert(!is_ecd_certificate(bowtie, {{{0, 1}, {1, 2}, {2, 3}, {3, 0}}, {{0, 4}, {4, 5}, {5, 6}, {0, 1}}}));
+        EdgeList triangles{5, {{0, 1}, {1, 2}, {2, 0}, {0, 3}, {3, 4}, {4, 0}}};
+        assert(!is_ecd_certificate(triangles, {{{0, 1}, {1, 2}, {2, 0}}, {{0, 3}, {3, 4}, {4, 0}}}));
+        EdgeList digon{2, {{0, 1}, {1, 0}}};
+        assert(is_ecd_certificate(digon, {{{0, 1}, {0, 1}}}));
+        assert(!is_ecd_certificate(digon, {{{0, 1}}, {{0, 1}}}));
+        assert(!is_ecd_certificate(digon, {{{0, 1}, {0, 2}}}));
+        assert(!is_ecd_certificate(digon, {{{0, 1}, {-1, 1}}}));
+    }
+
+    // the counters of a search go to the innermost scope of the thread
+    {
+        EdgeList k5{5, {}};
+        for(int u = 0; u < 5; ++u)
+        {
+            for(int v = u + 1; v < 5; ++v)
+            {
+                k5.edges.emplace_back(u, v);
+            }
+        }
+        EcdStats outer, inner;
+        {
+            EcdStatsScope outer_scope(outer);
+            {
+                EcdStatsScope inner_scope(inner);
+                assert(internal::Ecd(k5).getSize() == -1);
+            }
+            assert(internal::ecd_stats() == (ecd_stats_enabled ? &outer : nullptr));
+        }
+        assert(internal::ecd_stats() == nullptr);
+        assert(outer.nodes == 0);
+        if(ecd_stats_enabled)
+        {
+            assert(inner.nodes > 0 && inner.prune_conflict > 0 && inner.nodes >= inner.prune_conflict);
+        }
+
+        // once no new class fits under the incumbent, the forward checking cuts branches of the 4-regular graphs
+        EcdStats regular;
+        {
+            EcdStatsScope scope(regular);
+            Graph6Stream stream("graphs/4regular/10_4_3.g6");
+            EdgeList g;
+            while(stream.next(g))
+            {
+                internal::Ecd ecd(g);
+                assert(ecd.getSize() == -1 || ecd.getSize() >= 2);
+            }
+        }
+        assert(!ecd_stats_enabled || regular.prune_forward > 0);
+    }
+
+    // every order of the edges finds the same sizes, random orders also when they are restarted after a few nodes
+    {
+        std::vector<EdgeList> graphs;
+        Graph6Stream stream("graphs/4regular/09_4_3.g6");
+        for(EdgeList g; stream.next(g);)
+        {
+            graphs.push_back(g);
+        }
+        EdgeList petersen_lg;
+        line_graph(edge_list(create_petersen()), petersen_lg);
+        graphs.push_back(petersen_lg);
+        for(auto& g : graphs)
+        {
+            int size = ecd_size(g);
+            for(EcdOrder order : {EcdOrder::bfs, EcdOrder::constrained, EcdOrder::degree, EcdOrder::random})
+            {
+                assert(ecd_size(g, EcdOrdering{order, 7}) == size);
+            }
+            assert(ecd_size(g, EcdOrdering{EcdOrder::random, 3, 10}) == size);
+        }
+    }
+
+    // the iterative search interrupted every few nodes and resumed from its checkpoint by a new one gives the same sizes
+    {
+        const std::string file = "test_ecd_checkpoint.tmp";
+        Graph6Stream stream("graphs/4regular/09_4_3.g6");
+        for(EdgeList g; stream.next(g);)
+        {
+            int size = ecd_size(g);
+            std::remove(file.c_str());
+            for(bool done = false; !done;)
+            {
+                internal::EcdIterative ecd(g, EcdOrdering{EcdOrder::bfs});
+                ecd.load(file);
+                done = ecd.step(50);
+                assert(!done || ecd.getSize() == size);
+                ecd.save(file);
+            }
+            std::remove(file.c_str());
+            assert(ecd_size_checkpointed(g, EcdCheckpoint{file, 0}) == size);
+        }
+        std::remove(file.c_str());
+
+        // a graph of two blocks stopped in its second one skips the finished first one and resumes the second,
+        // so the runs together explore the same nodes as one uninterrupted run (and the root of each resumed one)
+        EdgeList petersen_lg;
+        line_graph(edge_list(create_petersen()), petersen_lg);
+        Graph6Stream blocks("graphs/4regular/09_4_3.g6");
+        int tested = 0;
+        for(EdgeList a; tested < 2 && blocks.next(a);)
+        {
+            // without an ecd of the first block the second one is never searched
+            if(ecd_size(a) == -1)
+            {
+                continue;
+            }
+            tested++;
+            EdgeList g = a;
+            g.n = a.n + petersen_lg.n - 1;
+            for(auto [u, v] : petersen_lg.edges)
+            {
+                g.edges.emplace_back(u == 0 ? 0 : u + a.n - 1, v == 0 ? 0 : v + a.n - 1);
+            }
+            int size = ecd_size(g);
+            EcdStats whole, parts;
+            {
+                EcdStatsScope scope(whole);
+                assert(ecd_size_checkpointed(g, EcdCheckpoint{file}) == size);
+            }
+            int runs = 0;
+            bool second = false;
+            for(int res = ecd_timeout; res == ecd_timeout; ++runs)
+            {
+                {
+                    EcdStatsScope scope(parts);
+                    res = ecd_size_checkpointed(g, EcdCheckpoint{file, 60, 200});
+                }
+                assert(res == ecd_timeout || res == size);
+                internal::EcdCheckpointState state;
+                state.read(file);
+                second |= state.finished.size() == 1 && !state.active.empty();
+                assert(runs < 100000);
+            }
+            assert(second);
+            assert(!ecd_stats_enabled || parts.nodes <= whole.nodes + runs);
+            std::remove(file.c_str());
+        }
+    }
+
+    // a search out of its budget reports a timeout, otherwise the exact size, the fallback tries the next engine
+    {
+        Graph6Stream stream("graphs/4regular/09_4_3.g6");
+        int timeouts = 0;
+        for(EdgeList g; stream.next(g);)
+        {
+            int size = ecd_size(g);
+            int limited = ecd_size_within(g, {}, {0, 5});
+            assert(limited == ecd_timeout || limited == size);
+            timeouts += limited == ecd_timeout;
+            internal::Ecd random(g, INT_MAX, false, nullptr, EcdOrdering{EcdOrder::random, 1, 2}, 5);
+            assert(random.interrupted() || random.getSize() == size);
+
+            int answered;
+            std::vector<EcdAttempt> chain = {{}, {EcdEngine::backtracking, {EcdOrder::bfs}, {}}};
+            assert(ecd_size_fallback(g, chain, {60, 0}, &answered) == size && answered == 0);
+            limited = ecd_size_fallback(g, chain, {0, 5}, &answered);
+            assert(limited == ecd_timeout ? answered == -1 : limited == size && answered >= 0);
+#ifdef SAT
+            limited = ecd_size_within(g, {EcdEngine::sat, {}, {AmoEncoding::pairwise, false, SymmetryBreaking::none}}, {0, 1});
+            assert(limited == ecd_timeout || limited == size);
+            assert(ecd_size_within(g, {EcdEngine::sat, {}, {}}, {60, 0}) == size);
+#endif
+        }
+        assert(timeouts > 0);
+    }
+
+    // records skipped by nextLine do not shift the ones decoded after them, from a mapped file or a stream alike
+    {
+        const std::string file = "graphs/4regular/09_4_3.g6";
+        std::vector<EdgeList> all;
+        Graph6Stream stream(file);
+        for(EdgeList g; stream.next(g);)
+        {
+            all.push_back(g);
+        }
+        std::ifstream in(file);
+        Graph6Reader reader(in);
+        Graph6Stream skipping(file);
+        std::string_view line, skipped;
+        for(size_t i = 0; reader.nextLine(line); ++i)
+        {
+            assert(skipping.nextLine(skipped) && skipped == line);
+            if(i % 3 == 1)
+            {
+                EdgeList g;
+                decode_graph6(line, g);
+                assert(g.n == all[i].n && g.edges == all[i].edges);
+            }
+        }
+        assert(!skipping.nextLine(skipped));
+    }
+}